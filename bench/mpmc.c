@@ -0,0 +1,135 @@
+/*
+Contention of bounded MPMC queue: throughput for every pair of
+producer and consumer counts in 1, 2, 4 ... max_threads, with
+single da_mpmc_try_push/try_pop and with batched
+da_mpmc_try_push_many/try_pop_many.
+Usage: mpmc [items] [max_threads] [batch]
+    items       - count of items passed through queue, default 4000000
+    max_threads - biggest count of producers and of consumers,
+                  default count of online CPUs
+    batch       - items per batched call, default 32
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+DA_DEFINE_MPMC(long, queue_t)
+DA_DEFINE_MPMC_INIT(long)
+DA_DEFINE_MPMC_TRY_PUSH(long)
+DA_DEFINE_MPMC_TRY_POP(long)
+DA_DEFINE_MPMC_TRY_PUSH_MANY(long)
+DA_DEFINE_MPMC_TRY_POP_MANY(long)
+DA_DEFINE_MPMC_FREE(long)
+
+#define CAPACITY 1024
+#define MAX_BATCH 256
+#define MAX_THREADS 64
+
+struct run {
+    queue_t queue;
+    size_t items;       /* per producer */
+    size_t batch;       /* 1 for single calls */
+    size_t total;       /* items of all producers */
+    _Atomic size_t popped;
+    _Atomic long long sum;
+};
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void* producer(void* ptr) {
+    struct run* run = ptr;
+    long values[MAX_BATCH];
+    size_t done = 0;
+    while (done < run->items) {
+        size_t n = 0;
+        if (run->batch == 1)
+            n = (size_t)da_mpmc_try_push(long)(&run->queue, (long)done);
+        else {
+            size_t count = run->items - done < run->batch
+                ? run->items - done : run->batch;
+            DA_FORLOOP(i, 0, count) values[i] = (long)(done + i);
+            n = da_mpmc_try_push_many(long)(&run->queue, values, count);
+        }
+        if (n == 0) sched_yield();
+        done += n;
+    }
+    return NULL;
+}
+
+static void* consumer(void* ptr) {
+    struct run* run = ptr;
+    long values[MAX_BATCH];
+    long long sum = 0;
+    while (atomic_load_explicit(&run->popped, memory_order_relaxed)
+        < run->total) {
+        size_t n = run->batch == 1
+            ? (size_t)da_mpmc_try_pop(long)(&run->queue, values)
+            : da_mpmc_try_pop_many(long)(&run->queue, values, run->batch);
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        DA_FORLOOP(i, 0, n) sum += values[i];
+        atomic_fetch_add_explicit(&run->popped, n, memory_order_relaxed);
+    }
+    atomic_fetch_add(&run->sum, sum);
+    return NULL;
+}
+
+/* millions of items per second */
+static double measure(size_t producers, size_t consumers,
+size_t items, size_t batch) {
+    struct run run;
+    da_mpmc_init(long)(&run.queue, CAPACITY, NULL);
+    run.items = items / producers;
+    run.batch = batch;
+    run.total = run.items * producers;
+    atomic_init(&run.popped, 0);
+    atomic_init(&run.sum, 0);
+    pthread_t threads[2 * MAX_THREADS];
+    double start = now();
+    DA_FORLOOP(i, 0, producers)
+        pthread_create(&threads[i], NULL, producer, &run);
+    DA_FORLOOP(i, 0, consumers)
+        pthread_create(&threads[producers + i], NULL, consumer, &run);
+    DA_FORLOOP(i, 0, producers + consumers)
+        pthread_join(threads[i], NULL);
+    double time = now() - start;
+    long long expected = (long long)producers
+        * (long long)run.items * ((long long)run.items - 1) / 2;
+    if (atomic_load(&run.sum) != expected) {
+        fputs("lost items\n", stderr);
+        exit(1);
+    }
+    da_mpmc_free(long)(&run.queue);
+    return run.total / time * 1e-6;
+}
+
+int main(int argc, char** argv) {
+    size_t items = argc > 1 ? strtoul(argv[1], NULL, 10) : 4000000;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10)
+        : cpus > 0 ? (size_t)cpus : 1;
+    size_t batch = argc > 3 ? strtoul(argv[3], NULL, 10) : 32;
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+    if (batch < 2) batch = 2;
+    if (batch > MAX_BATCH) batch = MAX_BATCH;
+    printf("%zu items, capacity %d, batch %zu, Mitems/s\n",
+        items, CAPACITY, batch);
+    printf("%9s %9s %10s %10s\n",
+        "producers", "consumers", "single", "batched");
+    for (size_t p = 1; p <= max_threads; p *= 2)
+        for (size_t c = 1; c <= max_threads; c *= 2)
+            printf("%9zu %9zu %10.2f %10.2f\n", p, c,
+                measure(p, c, items, 1), measure(p, c, items, batch));
+    return 0;
+}
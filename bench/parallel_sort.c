@@ -0,0 +1,88 @@
+/*
+Scaling of da_parallel_sort from 1 to N workers.
+Usage: parallel_sort [count] [max_threads]
+    count       - count of int items, default 10000000
+    max_threads - biggest pool, default count of online CPUs
+Every pool size sorts same random input and input with only
+16 different values (many keys equal to splitters).
+*/
+
+#define _POSIX_C_SOURCE 200809L
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+#define int_less(a, b) ((a) < (b))
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_SORT(int, int_less)
+DA_DEFINE_PARALLEL_SORT(int, int_less)
+
+#define REPEATS 3
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* best time of REPEATS sorts of copy of `input` */
+static double measure(const ints_t* input, ints_t* work, da_pool* pool) {
+    double best = 0;
+    DA_FORLOOP(r, 0, REPEATS) {
+        work->count = 0;
+        da_append_many(int)(work, input->items, input->count);
+        double start = now();
+        da_parallel_sort(int)(work, pool);
+        double time = now() - start;
+        if (r == 0 || time < best) best = time;
+    }
+    DA_FORLOOP(i, 1, work->count)
+        if (work->items[i] < work->items[i - 1]) {
+            fputs("not sorted\n", stderr);
+            exit(1);
+        }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000000;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = argc > 2 ? strtoul(argv[2], NULL, 10)
+        : cpus > 0 ? (size_t)cpus : 1;
+    ints_t random = {0}, few = {0}, work = {0};
+    uint64_t state = 88172645463325252ull;
+    DA_FORLOOP(i, 0, count) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        da_append(int)(&random, (int)(state >> 33));
+        da_append(int)(&few, (int)(state >> 60));
+    }
+    printf("%zu items\n%8s %12s %8s %12s %8s\n", count,
+        "threads", "random, ms", "speedup", "16 keys, ms", "speedup");
+    double base_random = 0, base_few = 0;
+    for (size_t threads = 1; threads <= max_threads; ++threads) {
+        da_pool* pool = da_pool_create(threads);
+        if (pool == NULL) {
+            fputs("not memory\n", stderr);
+            return 1;
+        }
+        double t_random = measure(&random, &work, pool);
+        double t_few = measure(&few, &work, pool);
+        da_pool_destroy(pool);
+        if (threads == 1) {
+            base_random = t_random;
+            base_few = t_few;
+        }
+        printf("%8zu %12.1f %8.2f %12.1f %8.2f\n", threads,
+            t_random * 1e3, base_random / t_random,
+            t_few * 1e3, base_few / t_few);
+    }
+    da_free(int)(&random);
+    da_free(int)(&few);
+    da_free(int)(&work);
+    return 0;
+}
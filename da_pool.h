@@ -0,0 +1,366 @@
+/*
+Overview:
+    Work-stealing pool of threads for parallel algorithms
+    of dynamic_array.h, may be used alone.
+    Need pthreads and C11 atomics.
+
+Scheme:
+    Every worker owns Chase-Lev deque^1 of ranges. Worker take range
+    from bottom of own deque, split it in halves while it greater
+    than grain, push right halves back and run left part. Idle
+    worker steal from top of other deques, so it get biggest ranges,
+    after DA_POOL_SPIN_ROUNDS failed rounds it park on condition
+    variable until new ranges pushed or job done. Between jobs
+    workers park on condition variable.
+
+API:
+- constants:
+    DA_CACHE_LINE      - size of cache line for padding of shared data
+    DA_POOL_DEQUE_SIZE - capacity of worker deque, power of two,
+                         range split in halves, so 64 is enough
+                         for any count
+
+- structures:
+    da_pool - pool of threads
+
+- functions:
+    da_pool_create       - create pool and start threads
+    da_pool_destroy      - stop threads and free pool
+    da_pool_threads      - count of workers
+    da_pool_parallel_for - call function for subranges of [0, count)
+
+Footnotes:
+    [1]: D. Chase, Y. Lev, "Dynamic circular work-stealing deque", 2005
+         and N. M. Le et al., "Correct and efficient work-stealing
+         for weak memory models", 2013
+*/
+
+#ifndef DA_POOL_H
+#define DA_POOL_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#ifndef DA_CACHE_LINE
+#define DA_CACHE_LINE 64
+#endif
+
+#define DA_POOL_DEQUE_SIZE 64
+
+/* Count of failed steal rounds before park of worker, for implementation */
+#define DA_POOL_SPIN_ROUNDS 64
+
+/**
+ * Chase-Lev deque of ranges packed as (begin << 32 | end),
+ * owner push and take at bottom, thieves steal at top,
+ * for implementation
+ */
+struct da_impl_deque {
+    _Alignas(DA_CACHE_LINE) _Atomic int64_t top;
+    _Alignas(DA_CACHE_LINE) _Atomic int64_t bottom;
+    _Atomic uint64_t ranges[DA_POOL_DEQUE_SIZE];
+};
+
+/* Pool of threads */
+typedef struct da_pool da_pool;
+struct da_pool {
+    pthread_t* threads;
+    size_t nthreads;       /* workers with calling thread */
+    pthread_mutex_t lock;
+    pthread_cond_t wake;   /* new job or stop */
+    pthread_cond_t done;   /* all workers leave job or get id */
+    pthread_cond_t work;   /* new ranges or end of job */
+    _Atomic size_t parked; /* workers waiting `work` */
+    size_t generation;     /* increment for every job */
+    size_t active;         /* workers in current job */
+    int stop;
+    _Atomic int busy;      /* job is running */
+    void (*fn)(void* ctx, size_t begin, size_t end);
+    void* ctx;
+    size_t grain;
+    _Atomic size_t remain; /* count of not done indices */
+    struct da_impl_deque* deques;
+};
+
+/* Empty value of deque, for implementation */
+#define DA_IMPL_RANGE_NONE UINT64_MAX
+
+/* Push range to bottom, only owner, for implementation */
+static inline void da_impl_deque_push(
+struct da_impl_deque* deque, uint64_t range) {
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_relaxed);
+    assert(b - atomic_load_explicit(&deque->top, memory_order_relaxed)
+        < DA_POOL_DEQUE_SIZE && "Deque overflow");
+    atomic_store_explicit(&deque->ranges[b % DA_POOL_DEQUE_SIZE],
+        range, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+}
+
+/* Take range from bottom, only owner, for implementation */
+static inline uint64_t da_impl_deque_take(struct da_impl_deque* deque) {
+    int64_t b = atomic_load_explicit(&deque->bottom,
+        memory_order_relaxed) - 1;
+    atomic_store_explicit(&deque->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_relaxed);
+    uint64_t range = DA_IMPL_RANGE_NONE;
+    if (t <= b) {
+        range = atomic_load_explicit(
+            &deque->ranges[b % DA_POOL_DEQUE_SIZE], memory_order_relaxed);
+        if (t == b) {
+            /* last range - race with thieves */
+            if (!atomic_compare_exchange_strong_explicit(&deque->top,
+                &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+                range = DA_IMPL_RANGE_NONE;
+            atomic_store_explicit(&deque->bottom,
+                b + 1, memory_order_relaxed);
+        }
+    } else
+        atomic_store_explicit(&deque->bottom, b + 1, memory_order_relaxed);
+    return range;
+}
+
+/* Steal range from top, any thread, for implementation */
+static inline uint64_t da_impl_deque_steal(struct da_impl_deque* deque) {
+    int64_t t = atomic_load_explicit(&deque->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    int64_t b = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+    if (t >= b) return DA_IMPL_RANGE_NONE;
+    uint64_t range = atomic_load_explicit(
+        &deque->ranges[t % DA_POOL_DEQUE_SIZE], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&deque->top,
+        &t, t + 1, memory_order_seq_cst, memory_order_relaxed))
+        return DA_IMPL_RANGE_NONE;
+    return range;
+}
+
+/* Wake all parked workers, for implementation */
+static inline void da_impl_pool_wake(da_pool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Is any range in deques, for implementation */
+static inline int da_impl_pool_has_ranges(da_pool* pool) {
+    for (size_t i = 0; i < pool->nthreads; ++i)
+        if (atomic_load(&pool->deques[i].top)
+            < atomic_load(&pool->deques[i].bottom))
+            return 1;
+    return 0;
+}
+
+/**
+ * Wait under lock until ranges pushed or job done, parked counter
+ * stored before check of deques and pusher load it after push,
+ * so one of them see other, for implementation
+ */
+static inline void da_impl_pool_park(da_pool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->parked, 1);
+    if (atomic_load(&pool->remain) > 0 && !da_impl_pool_has_ranges(pool))
+        pthread_cond_wait(&pool->work, &pool->lock);
+    atomic_fetch_sub(&pool->parked, 1);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Split range to grain, push right halves, run left, for implementation */
+static inline void da_impl_pool_exec(
+da_pool* pool, struct da_impl_deque* own, uint64_t range) {
+    size_t begin = (size_t)(range >> 32), end = (size_t)(range & 0xFFFFFFFF);
+    int pushed = 0;
+    while (end - begin > pool->grain) {
+        size_t mid = begin + (end - begin) / 2;
+        da_impl_deque_push(own, (uint64_t)mid << 32 | end);
+        end = mid;
+        pushed = 1;
+    }
+    if (pushed) {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(&pool->parked, memory_order_relaxed) > 0)
+            da_impl_pool_wake(pool);
+    }
+    pool->fn(pool->ctx, begin, end);
+    /* last range of job: parked workers leave job */
+    if (atomic_fetch_sub_explicit(&pool->remain,
+        end - begin, memory_order_acq_rel) == end - begin)
+        da_impl_pool_wake(pool);
+}
+
+/* Work of worker `id` in current job, for implementation */
+static inline void da_impl_pool_work(da_pool* pool, size_t id) {
+    struct da_impl_deque* own = &pool->deques[id];
+    size_t fails = 0;
+    while (atomic_load_explicit(&pool->remain, memory_order_acquire) > 0) {
+        uint64_t range = da_impl_deque_take(own);
+        for (size_t k = 1; range == DA_IMPL_RANGE_NONE
+            && k < pool->nthreads; ++k)
+            range = da_impl_deque_steal(
+                &pool->deques[(id + k) % pool->nthreads]);
+        if (range != DA_IMPL_RANGE_NONE) {
+            da_impl_pool_exec(pool, own, range);
+            fails = 0;
+        } else if (++fails >= DA_POOL_SPIN_ROUNDS) {
+            da_impl_pool_park(pool);
+            fails = 0;
+        }
+    }
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->active == 0)
+        pthread_cond_signal(&pool->done);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Loop of pool thread, for implementation */
+static inline void* da_impl_pool_thread(void* ptr) {
+    da_pool* pool = ptr;
+    pthread_mutex_lock(&pool->lock);
+    size_t id = pool->active++, seen = 0;
+    pthread_cond_signal(&pool->done);
+    pthread_mutex_unlock(&pool->lock);
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stop && pool->generation == seen)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        seen = pool->generation;
+        int stop = pool->stop;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) return NULL;
+        da_impl_pool_work(pool, id);
+    }
+}
+
+/**
+ * @brief create pool with `nthreads` workers, calling thread
+ * of da_pool_parallel_for is also worker, so pool start
+ * `nthreads` - 1 threads, threads sleep between jobs
+ * @param nthreads count of workers
+ * @return pointer to pool or NULL if not memory
+ */
+static inline da_pool* da_pool_create(size_t nthreads) {
+    da_pool* pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) return NULL;
+    if (nthreads == 0) nthreads = 1;
+    pool->threads = malloc(nthreads * sizeof(*pool->threads));
+    pool->deques = aligned_alloc(DA_CACHE_LINE,
+        nthreads * sizeof(*pool->deques));
+    if (pool->threads == NULL || pool->deques == NULL) {
+        free(pool->threads);
+        free(pool->deques);
+        free(pool);
+        return NULL;
+    }
+    for (size_t i = 0; i < nthreads; ++i) {
+        atomic_init(&pool->deques[i].top, 0);
+        atomic_init(&pool->deques[i].bottom, 0);
+    }
+    atomic_init(&pool->busy, 0);
+    atomic_init(&pool->remain, 0);
+    atomic_init(&pool->parked, 0);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pool->active = 1; /* id 0 for calling thread */
+    pool->nthreads = 1;
+    for (size_t i = 1; i < nthreads; ++i)
+        if (pthread_create(&pool->threads[pool->nthreads],
+            NULL, da_impl_pool_thread, pool) == 0)
+            ++pool->nthreads;
+    /* wait until all threads get id */
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active != pool->nthreads)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pool->active = 0;
+    pthread_mutex_unlock(&pool->lock);
+    return pool;
+}
+
+/**
+ * @brief stop threads of `pool` and free memory
+ * @param pool pointer to pool, may be NULL
+ */
+static inline void da_pool_destroy(da_pool* pool) {
+    if (pool == NULL) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->nthreads; ++i)
+        pthread_join(pool->threads[i], NULL);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    free(pool->threads);
+    free(pool->deques);
+    free(pool);
+}
+
+/**
+ * @brief count of workers in `pool`
+ * @param pool pointer to pool, may be NULL
+ * @return 1 for NULL
+ */
+static inline size_t da_pool_threads(const da_pool* pool) {
+    return pool != NULL ? pool->nthreads : 1;
+}
+
+/**
+ * @brief call `fn` for disjoint subranges covering [0, `count`),
+ * subranges is not greater than `grain` (or 1 if `grain` is 0),
+ * return after all calls done, if `pool` is NULL or other job
+ * is running in `pool` (nested call), call `fn` for subranges
+ * in order on calling thread
+ * @param pool pointer to pool or NULL
+ * @param count count of indices, not greater than 2^32 - 1
+ * @param grain maximal count of indices for one call of `fn`
+ * @param fn function as `void fn(void* ctx, size_t begin, size_t end)`
+ * @param ctx user data passed to `fn`
+ */
+static inline void da_pool_parallel_for(da_pool* pool,
+size_t count, size_t grain,
+void (*fn)(void* ctx, size_t begin, size_t end), void* ctx) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+    int idle = 0;
+    if (pool == NULL || pool->nthreads == 1 || count <= grain
+    || !atomic_compare_exchange_strong(&pool->busy, &idle, 1)) {
+        for (size_t begin = 0; begin < count; begin += grain)
+            fn(ctx, begin, count - begin > grain ? begin + grain : count);
+        return;
+    }
+    assert(count < 0xFFFFFFFF && "Too many indices");
+    size_t n = pool->nthreads;
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->grain = grain;
+    atomic_store(&pool->remain, count);
+    /* first ranges split evenly, workers are not running */
+    for (size_t i = 0; i < n; ++i) {
+        size_t begin = count * i / n, end = count * (i + 1) / n;
+        atomic_store(&pool->deques[i].top, 0);
+        atomic_store(&pool->deques[i].bottom, 0);
+        if (begin < end)
+            da_impl_deque_push(&pool->deques[i],
+                (uint64_t)begin << 32 | end);
+    }
+    pool->active = n;
+    ++pool->generation;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    da_impl_pool_work(pool, 0);
+    pthread_mutex_lock(&pool->lock);
+    while (pool->active != 0)
+        pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    atomic_store(&pool->busy, 0);
+}
+
+#endif // DA_POOL_H
@@ -17,8 +17,34 @@ API:
 - constants:
     DA_DEFAULT_INIT_CAP - default capacity for just created 'da'^2,
                           maybe set by user before include this file
+    DA_SEGMENT_BASE     - size of first segment of segmented array,
+                          power of two, maybe set by user before include
+    DA_SPARSE_PAGE_SIZE - count of keys in page of sparse set,
+                          maybe set by user before include
+    DA_COW_CHUNK_SIZE   - count of items in chunk of copy-on-write
+                          array, maybe set by user before include
+    DA_ROPE_LEAF_BYTES  - size of items in leaf of rope,
+                          maybe set by user before include
+    DA_ENABLE_THREADS   - define before include this file for enable
+                          parallel functions on da_pool^3 from
+                          da_pool.h, need pthreads and C11 (atomics,
+                          aligned_alloc), without it file is C99
+    DA_NO_SIMD          - define before include this file for disable
+                          SIMD kernels and CPU dispatch
+    DA_SIMD_INTEGERS    - define before include this file for choose
+                          SIMD kernels only by size of type, without
+                          _Generic, so SIMD work in C99: find, count
+                          and scans must be defined only for integers
+                          and pointers; SIMD need C11 without it
+    DA_PARALLEL_SORT_THRESHOLD -
+                          minimal count of items for sort on several
+                          threads, maybe set by user before include
+    DA_PARALLEL_SCAN_THRESHOLD -
+                          minimal count of items for scan on several
+                          threads, maybe set by user before include
 
 - structures:
+    da_handle         - handle of value in slot map
     DA_DEFINE_CUSTOM_FIELDS_STRUCT -
                         create definition for 'da' struct
                         with passed type, name and custom
@@ -28,6 +54,60 @@ API:
     DA_DEFINE_STRUCT  - create definition for 'da' struct
                         with passed type and name
     DA_FOREACH        - For-loop macros, as range-based for-loop in C++
+    DA_DECLARE_SEGMENTED_STRUCT/DA_DEFINE_SEGMENTED_STRUCT -
+                        create segmented array with stable addresses
+    DA_SEGMENTED_FOREACH - For-loop macros over segmented array
+    DA_DECLARE_DEQUE/DA_DEFINE_DEQUE -
+                        create double-ended queue on circular buffer
+    DA_DEQUE_FOREACH  - For-loop macros over deque by two spans
+    DA_DECLARE_GAP_BUFFER/DA_DEFINE_GAP_BUFFER -
+                        create gap buffer for edits at cursor
+    DA_DECLARE_SOA/DA_DEFINE_SOA -
+                        create struct of arrays with column per field
+                        from pairs `(type, field)` and its functions
+    DA_DEFINE_SOA_FUNCTIONS -
+                        define functions for DA_DECLARE_SOA
+    DA_DECLARE_BITARRAY/DA_DEFINE_BITARRAY -
+                        create bit array with 64 flags per word
+                        and its functions
+    DA_DEFINE_BITARRAY_FUNCTIONS -
+                        define functions for DA_DECLARE_BITARRAY
+    DA_DECLARE_SLOTMAP/DA_DEFINE_SLOTMAP -
+                        create slot map with packed values and
+                        generational handles
+    DA_DECLARE_SPARSE_SET/DA_DEFINE_SPARSE_SET -
+                        create sparse set of integer keys
+                        with paged sparse array
+    DA_DECLARE_HIVE/DA_DEFINE_HIVE -
+                        create hive of blocks with stable addresses
+                        and skipfield
+    DA_HIVE_FOREACH   - For-loop macros over hive
+    DA_DECLARE_COW/DA_DEFINE_COW -
+                        create copy-on-write array of refcounted
+                        chunks with O(1) snapshots, refcounts
+                        atomic if DA_ENABLE_THREADS
+    DA_DECLARE_ROPE/DA_DEFINE_ROPE -
+                        create B+tree sequence with contiguous leaves
+    DA_ROPE_FOREACH   - For-loop macros over rope by leaves
+    DA_DECLARE_CONCURRENT_STRUCT/DA_DEFINE_CONCURRENT_STRUCT -
+                        create segmented array for appends from
+                        many threads, need DA_ENABLE_THREADS
+    DA_DECLARE_SHARDED_STRUCT/DA_DEFINE_SHARDED_STRUCT -
+                        create set of 'da' with shard per thread,
+                        need DA_ENABLE_THREADS
+    DA_DECLARE_EPOCH_STRUCT/DA_DEFINE_EPOCH_STRUCT -
+                        create 'da' struct for one writer and many
+                        readers with epoch-based reclamation,
+                        need DA_ENABLE_THREADS
+    DA_DECLARE_SEQLOCK_STRUCT/DA_DEFINE_SEQLOCK_STRUCT -
+                        create 'da' under seqlock for rarely updated
+                        tables, need DA_ENABLE_THREADS
+    DA_DECLARE_RING/DA_DEFINE_RING -
+                        create ring buffer for one producer and one
+                        consumer, need DA_ENABLE_THREADS
+    DA_DECLARE_MPMC/DA_DEFINE_MPMC -
+                        create bounded queue for many producers and
+                        consumers, need DA_ENABLE_THREADS
     DA_DECLARE_ALL    - expand to all declaration macros
     DA_DEFINE_ALL     - expand to all definition macros
 
@@ -41,10 +121,151 @@ API:
                        and shift other items
     da_reserve       - reserve places for items
     da_shrink_to_fit - reset capacity equal count
+    da_sort          - sort items by passed `less` macro (introsort)
+    da_sort_range    - sort raw array by passed `less` macro
+    da_lower_bound   - index of first item not less than value
+    da_upper_bound   - index of first item greater than value
+    da_equal_range   - range of items equal to value
+    da_binary_search - check sorted 'da' contains value
+    da_insert_sorted - insert value into sorted 'da' keeping order
+    da_merge_sorted_many -
+                       merge sorted values into sorted 'da' in place
+    da_find          - index of first item equal to value (SIMD)
+    da_count         - count items equal to value (SIMD)
+    da_contains      - check 'da' contains value (SIMD)
+    da_sum           - sum of items (SIMD-friendly accumulators)
+    da_sum_pairwise  - sum of items by pairwise summation
+    da_sum_kahan     - sum of items by Kahan summation
+    da_min           - minimal item
+    da_max           - maximal item
+    da_minmax        - minimal and maximal items by one pass
+    da_argmin        - index of first minimal item
+    da_argmax        - index of first maximal item
+    da_inclusive_scan - inclusive prefix sums (SIMD for integers)
+    da_exclusive_scan - exclusive prefix sums (SIMD for integers)
+    da_map           - append results of function for items of other
+                       'da' with one reservation
+    da_filter        - append items of other 'da' passed predicate
+                       with one reservation, or filter in place
+    da_segmented_at  - pointer to item of segmented array, O(1)
+    da_segmented_append -
+                       append value to segmented array, items never move
+    da_segmented_free - free segmented array
+    da_deque_at      - pointer to item of deque, O(1)
+    da_deque_push_back, da_deque_push_front -
+                       add value to end or begin of deque
+    da_deque_pop_back, da_deque_pop_front -
+                       remove and return last or first item of deque
+    da_deque_free    - free deque
+    da_gap_at        - pointer to item of gap buffer, O(1)
+    da_gap_move      - move cursor of gap buffer
+    da_gap_insert    - insert value at cursor, O(1) amortized
+    da_gap_delete    - remove items after cursor
+    da_gap_spans     - items before and after cursor without copy
+    da_gap_free      - free gap buffer, need da_gap_at
+    da_soa_reserve   - reserve places in all columns of struct of arrays
+    da_soa_append    - append values of fields to struct of arrays
+    da_soa_free      - free struct of arrays
+    da_bits_append, da_bits_append_many -
+                       append bit or flags from bytes to bit array
+    da_bits_get, da_bits_set -
+                       get and set bit of bit array
+    da_bits_popcount - count set bits (SIMD)
+    da_bits_find_first_set -
+                       index of first set bit from index (SIMD)
+    da_bits_and, da_bits_or, da_bits_xor -
+                       bulk bitwise operations by words
+    da_bits_free     - free bit array
+    da_slotmap_insert - insert value to slot map, return handle
+    da_slotmap_get   - pointer to value by handle or NULL if stale
+    da_slotmap_erase - erase value by handle, O(1)
+    da_slotmap_free  - free slot map
+    da_sparse_add    - add key to sparse set, O(1)
+    da_sparse_remove - remove key from sparse set, O(1)
+    da_sparse_contains - check sparse set contains key, O(1)
+    da_sparse_free   - free sparse set
+    da_hive_insert   - insert value to hive, return stable pointer
+    da_hive_erase    - erase value of hive by pointer
+    da_hive_free     - free hive
+    da_cow_at        - pointer to item of copy-on-write array for read
+    da_cow_set       - set item, copy shared chunk only
+    da_cow_append    - append value to copy-on-write array
+    da_cow_snapshot  - snapshot of copy-on-write array, O(1)
+    da_cow_free      - release copy-on-write array or snapshot
+    da_rope_at       - pointer to item of rope, O(log n)
+    da_rope_insert_at - insert value before index, O(log n)
+    da_rope_append   - append value to end of rope, O(log n)
+    da_rope_remove_at - destroy item at index, O(log n)
+    da_rope_free     - free rope
+    da_parallel_sort - sort items on thread pool (sample sort),
+                       need DA_ENABLE_THREADS
+    da_parallel_inclusive_scan, da_parallel_exclusive_scan -
+                       prefix sums on thread pool by two passes,
+                       need DA_ENABLE_THREADS
+    da_parallel_for  - call function for every item on thread pool,
+                       need DA_ENABLE_THREADS
+    da_concurrent_at - pointer to item of concurrent 'da', O(1),
+                       need DA_ENABLE_THREADS
+    da_concurrent_append -
+                       append value from any thread, lock-free by one
+                       atomic increment, need DA_ENABLE_THREADS
+    da_concurrent_free - free concurrent 'da', need DA_ENABLE_THREADS
+    da_sharded_init  - allocate shards, need DA_ENABLE_THREADS
+    da_sharded_append - append value to shard of calling thread
+                       without atomics, need DA_ENABLE_THREADS
+    da_sharded_collect -
+                       move items of all shards to 'da' by parallel
+                       memcpy, need DA_ENABLE_THREADS
+    da_sharded_free  - free all shards, need DA_ENABLE_THREADS
+    da_epoch_init    - allocate slots of readers, need DA_ENABLE_THREADS
+    da_epoch_append  - append value by writer, old buffer retired
+                       on growth, need DA_ENABLE_THREADS
+    da_read_begin, da_read_end -
+                       section of reader, items stay valid inside,
+                       need DA_ENABLE_THREADS
+    da_epoch_reclaim - free retired buffers left by all readers,
+                       call by writer when appends stop,
+                       need DA_ENABLE_THREADS
+    da_epoch_free    - free epoch 'da', need DA_ENABLE_THREADS
+    da_seqlock_write_begin, da_seqlock_write_end -
+                       change of seqlock 'da' by writer,
+                       need DA_ENABLE_THREADS
+    da_seqlock_read_begin, da_seqlock_read_retry, da_seqlock_items -
+                       optimistic read of seqlock 'da',
+                       need DA_ENABLE_THREADS
+    da_seqlock_copy  - copy snapshot of seqlock 'da',
+                       need DA_ENABLE_THREADS
+    da_seqlock_append, da_seqlock_remove -
+                       append and remove under seqlock,
+                       need DA_ENABLE_THREADS
+    da_seqlock_free  - free seqlock 'da', need DA_ENABLE_THREADS
+    da_ring_init     - allocate ring, need DA_ENABLE_THREADS
+    da_ring_push, da_ring_pop -
+                       push by producer and pop by consumer without
+                       lock, need DA_ENABLE_THREADS
+    da_ring_push_many, da_ring_pop_many -
+                       push and pop batch by memcpy,
+                       need DA_ENABLE_THREADS
+    da_ring_free     - free ring, need DA_ENABLE_THREADS
+    da_mpmc_init     - allocate queue, need DA_ENABLE_THREADS
+    da_mpmc_try_push, da_mpmc_try_pop -
+                       push and pop from any thread without lock,
+                       need DA_ENABLE_THREADS
+    da_mpmc_try_push_many, da_mpmc_try_pop_many -
+                       push and pop batch by one CAS,
+                       need DA_ENABLE_THREADS
+    da_mpmc_free     - free queue, need DA_ENABLE_THREADS
 
 Footnotes:
     [1]: https://github.com/tsoding/nob.h
     [2]: 'da' - object of type dynamic array
+    [3]: 'da_pool' - work-stealing pool of threads, see da_pool.h
+    [4]: K. Fraser, "Practical lock-freedom", 2004, epoch-based
+         reclamation
+    [5]: D. Vyukov, "Bounded MPMC queue", 1024cores.net
+    [6]: W. Mula, N. Kurz, D. Lemire, "Faster population counts
+         using AVX2 instructions", 2016
+    [7]: M. Bentley, "The low complexity jump-counting pattern", 2019
 */
 
 #ifndef DYNAMIC_ARRAY_H
@@ -54,6 +275,18 @@ Footnotes:
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
+
+#ifdef DA_ENABLE_THREADS
+#include <sched.h>
+#include "da_pool.h"
+#endif
+
+#if !defined(DA_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) \
+    && (defined(__x86_64__) || defined(__i386__))
+#define DA_X86_SIMD
+#include <immintrin.h>
+#endif
 
 #ifndef DA_DEFAULT_INIT_CAP
 #define DA_DEFAULT_INIT_CAP 64
@@ -62,6 +295,30 @@ Footnotes:
 #define DA_DEFAULT_INIT_CAP 64
 #endif
 
+#ifndef DA_SEGMENT_BASE
+#define DA_SEGMENT_BASE 64
+#endif
+
+#ifndef DA_SPARSE_PAGE_SIZE
+#define DA_SPARSE_PAGE_SIZE 4096
+#endif
+
+#ifndef DA_COW_CHUNK_SIZE
+#define DA_COW_CHUNK_SIZE 512
+#endif
+
+#ifndef DA_ROPE_LEAF_BYTES
+#define DA_ROPE_LEAF_BYTES 4096
+#endif
+
+#ifndef DA_PARALLEL_SORT_THRESHOLD
+#define DA_PARALLEL_SORT_THRESHOLD (1 << 16)
+#endif
+
+#ifndef DA_PARALLEL_SCAN_THRESHOLD
+#define DA_PARALLEL_SCAN_THRESHOLD (1 << 18)
+#endif
+
 #define DA_FUNC_NAME(name, type) da_fn_ ## name ## _ ## type
 #define DA_STRUCT_NAME(type)     da_struct_          ## type
 
@@ -69,6 +326,32 @@ Footnotes:
 #define DA_FORLOOP(var, init, end) \
 for (size_t var = init; var < end; ++var)
 
+/* Grow capacity of `da` by growth policy
+for fit `need` items, for implementation */
+#define DA_GROW(da, need)                               \
+do {                                                    \
+    if ((need) > (da)->capacity) {                      \
+        if ((da)->capacity == 0)                        \
+            (da)->capacity = DA_DEFAULT_INIT_CAP;       \
+        while ((need) > (da)->capacity)                 \
+            (da)->capacity += ((da)->capacity + 1) / 2; \
+        (da)->items = realloc((da)->items,              \
+            (da)->capacity * sizeof(*(da)->items));     \
+        assert((da)->items != NULL && "Not memory");    \
+    }                                                   \
+} while (0)
+
+/* Set capacity of `da` at least `new_cap`, for implementation */
+#define DA_RESERVE(da, new_cap)                      \
+do {                                                 \
+    if ((da)->capacity < (new_cap)) {                \
+        (da)->capacity = (new_cap);                  \
+        (da)->items = realloc((da)->items,           \
+            (da)->capacity * sizeof(*(da)->items));  \
+        assert((da)->items != NULL && "Not memory"); \
+    }                                                \
+} while (0)
+
 /* For loop macros, as range-for in c++ */
 #define DA_FOREACH(type, item_ptr_name, da)    \
 for (type* item_ptr_name = (da)->items;        \
@@ -125,20 +408,12 @@ void da_append_many(type)(            \
 struct DA_STRUCT_NAME(type)* da,      \
 const type* values,                   \
 size_t values_count)
-#define DA_DEFINE_APPEND_MANY(type)                     \
-DA_DECLARE_APPEND_MANY(type) {                          \
-    if (da->count + values_count > da->capacity) {      \
-        if (da->capacity == 0)                          \
-            da->capacity = DA_DEFAULT_INIT_CAP;         \
-        while (da->count + values_count > da->capacity) \
-            da->capacity += (da->capacity + 1) / 2;     \
-        da->items = realloc(da->items,                  \
-            da->capacity * sizeof(*da->items));         \
-        assert(da->items != NULL && "Not memory");      \
-    }                                                   \
-    memcpy(da->items + da->count, values,               \
-        values_count * sizeof(*da->items));             \
-    da->count += values_count;                          \
+#define DA_DEFINE_APPEND_MANY(type)           \
+DA_DECLARE_APPEND_MANY(type) {                \
+    DA_GROW(da, da->count + values_count);    \
+    memcpy(da->items + da->count, values,     \
+        values_count * sizeof(*da->items));   \
+    da->count += values_count;                \
 }
 
 /**
@@ -240,13 +515,9 @@ DA_DECLARE_REMOVE_MANY(type) {      \
 void da_reserve(type)(           \
 struct DA_STRUCT_NAME(type)* da, \
 size_t new_cap)
-#define DA_DEFINE_RESERVE(type)                \
-DA_DECLARE_RESERVE(type) {                     \
-    if (da->capacity >= new_cap) return;       \
-    da->capacity = new_cap;                    \
-    da->items = realloc(da->items,             \
-        da->capacity * sizeof(*da->items));    \
-    assert(da->items != NULL && "Not memory"); \
+#define DA_DEFINE_RESERVE(type) \
+DA_DECLARE_RESERVE(type) {      \
+    DA_RESERVE(da, new_cap);    \
 }
 
 /**
@@ -287,4 +558,4279 @@ DA_DEFINE_REMOVE_MANY(type)  \
 DA_DEFINE_RESERVE(type)      \
 DA_DEFINE_SHRINK_TO_FIT(type)
 
+/* Count of items, which sort by insertion sort, for implementation */
+#define DA_SORT_INSERTION_THRESHOLD 16
+
+/* Swap two values of type `type`, for implementation */
+#define DA_SWAP(type, a, b) \
+do { type da_swap_tmp = (a); (a) = (b); (b) = da_swap_tmp; } while (0)
+
+/**
+ * @brief sort `count` items of raw array `items`,
+ * order set by `less` macro from DA_DEFINE_SORT
+ * @param items pointer to array of values
+ * @param count count items in `items`
+ */
+#define da_sort_range(type) DA_FUNC_NAME(sort_range, type)
+/**
+ * @brief sort items of `da`, order set by
+ * `less` macro from DA_DEFINE_SORT (not stable)
+ * @param da pointer to dynamic array
+ */
+#define da_sort(type) DA_FUNC_NAME(sort, type)
+#define DA_DECLARE_SORT(type)                        \
+void da_sort_range(type)(type* items, size_t count); \
+void da_sort(type)(struct DA_STRUCT_NAME(type)* da)
+/**
+ * `less` - macro or function as `less(a, b)`, where `a` and `b`
+ * is values of type `type`, return non-zero if `a` less than `b`
+ */
+#define DA_DEFINE_SORT(type, less)                           \
+static void DA_FUNC_NAME(sort_insertion, type)(              \
+type* items, size_t count) {                                 \
+    DA_FORLOOP(i, 1, count) {                                \
+        type value = items[i];                               \
+        size_t j = i;                                        \
+        for (; j > 0 && less(value, items[j - 1]); --j)      \
+            items[j] = items[j - 1];                         \
+        items[j] = value;                                    \
+    }                                                        \
+}                                                            \
+static void DA_FUNC_NAME(sort_sift, type)(                   \
+type* items, size_t root, size_t count) {                    \
+    type value = items[root];                                \
+    for (size_t child; (child = 2 * root + 1) < count;) {    \
+        if (child + 1 < count                                \
+        && less(items[child], items[child + 1]))             \
+            ++child;                                         \
+        if (!less(value, items[child])) break;               \
+        items[root] = items[child];                          \
+        root = child;                                        \
+    }                                                        \
+    items[root] = value;                                     \
+}                                                            \
+static void DA_FUNC_NAME(sort_heap, type)(                   \
+type* items, size_t count) {                                 \
+    for (size_t i = count / 2; i > 0; --i)                   \
+        DA_FUNC_NAME(sort_sift, type)(items, i - 1, count);  \
+    for (size_t i = count - 1; i > 0; --i) {                 \
+        DA_SWAP(type, items[0], items[i]);                   \
+        DA_FUNC_NAME(sort_sift, type)(items, 0, i);          \
+    }                                                        \
+}                                                            \
+static void DA_FUNC_NAME(sort_intro, type)(                  \
+type* items, size_t count, size_t depth) {                   \
+    while (count > DA_SORT_INSERTION_THRESHOLD) {            \
+        if (depth-- == 0) {                                  \
+            DA_FUNC_NAME(sort_heap, type)(items, count);     \
+            return;                                          \
+        }                                                    \
+        /* median of three as pivot */                       \
+        size_t mid = count / 2;                              \
+        if (less(items[mid], items[0]))                      \
+            DA_SWAP(type, items[mid], items[0]);             \
+        if (less(items[count - 1], items[mid])) {            \
+            DA_SWAP(type, items[count - 1], items[mid]);     \
+            if (less(items[mid], items[0]))                  \
+                DA_SWAP(type, items[mid], items[0]);         \
+        }                                                    \
+        type pivot = items[mid];                             \
+        /* Hoare partition: [0, i) <= pivot <= [i, count) */ \
+        size_t i = 0, j = count - 1;                         \
+        for (;;) {                                           \
+            while (less(items[i], pivot)) ++i;               \
+            while (less(pivot, items[j])) --j;               \
+            if (i >= j) break;                               \
+            DA_SWAP(type, items[i], items[j]);               \
+            ++i; --j;                                        \
+        }                                                    \
+        i = j + 1;                                           \
+        /* recursion for less part, loop for greater */      \
+        if (i < count - i) {                                 \
+            DA_FUNC_NAME(sort_intro, type)(items, i, depth); \
+            items += i; count -= i;                          \
+        } else {                                             \
+            DA_FUNC_NAME(sort_intro, type)(                  \
+                items + i, count - i, depth);                \
+            count = i;                                       \
+        }                                                    \
+    }                                                        \
+    DA_FUNC_NAME(sort_insertion, type)(items, count);        \
+}                                                            \
+void da_sort_range(type)(type* items, size_t count) {        \
+    size_t depth = 0;                                        \
+    for (size_t n = count; n > 1; n >>= 1)                   \
+        depth += 2;                                          \
+    DA_FUNC_NAME(sort_intro, type)(items, count, depth);     \
+}                                                            \
+void da_sort(type)(struct DA_STRUCT_NAME(type)* da) {        \
+    da_sort_range(type)(da->items, da->count);               \
+}
+
+/* Prefetch memory at `addr` for read, for implementation */
+#if defined(__GNUC__) || defined(__clang__)
+#define DA_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define DA_PREFETCH(addr) ((void)(addr))
+#endif
+
+/**
+ * @brief find index of first item not less than `value`
+ * in sorted `da`, or `da.count` if not exist
+ * @param da pointer to sorted dynamic array
+ * @param value value for search
+ */
+#define da_lower_bound(type) DA_FUNC_NAME(lower_bound, type)
+/**
+ * @brief find index of first item greater than `value`
+ * in sorted `da`, or `da.count` if not exist
+ * @param da pointer to sorted dynamic array
+ * @param value value for search
+ */
+#define da_upper_bound(type) DA_FUNC_NAME(upper_bound, type)
+/**
+ * @brief find range [`first`, `last`) of items equal to `value`
+ * in sorted `da`
+ * @param da pointer to sorted dynamic array
+ * @param value value for search
+ * @param first pointer to begin index of range
+ * @param last pointer to end index of range
+ */
+#define da_equal_range(type) DA_FUNC_NAME(equal_range, type)
+/**
+ * @brief check that sorted `da` contains `value`
+ * @param da pointer to sorted dynamic array
+ * @param value value for search
+ * @return non-zero if `value` found
+ */
+#define da_binary_search(type) DA_FUNC_NAME(binary_search, type)
+#define DA_DECLARE_SEARCH(type)                     \
+size_t da_lower_bound(type)(                        \
+const struct DA_STRUCT_NAME(type)* da, type value); \
+size_t da_upper_bound(type)(                        \
+const struct DA_STRUCT_NAME(type)* da, type value); \
+void da_equal_range(type)(                          \
+const struct DA_STRUCT_NAME(type)* da, type value,  \
+size_t* first, size_t* last);                       \
+int da_binary_search(type)(                         \
+const struct DA_STRUCT_NAME(type)* da, type value)
+/**
+ * Search without branches by result of comparison: range halved
+ * and choose by conditional move, both next middles is prefetched.
+ * `less` - macro or function as `less(a, b)`, where `a` and `b`
+ * is values of type `type`, return non-zero if `a` less than `b`
+ */
+#define DA_DEFINE_SEARCH(type, less)                        \
+static size_t DA_FUNC_NAME(lower_bound_range, type)(        \
+const type* items, size_t count, type value) {              \
+    if (count == 0) return 0;                               \
+    const type* base = items;                               \
+    while (count > 1) {                                     \
+        size_t half = count / 2;                            \
+        size_t next = (count - half) / 2;                   \
+        DA_PREFETCH(base + next);                           \
+        DA_PREFETCH(base + half + next);                    \
+        base = less(base[half], value)                      \
+            ? base + half : base;                           \
+        count -= half;                                      \
+    }                                                       \
+    return (size_t)(base - items)                           \
+        + (less(*base, value) != 0);                        \
+}                                                           \
+static size_t DA_FUNC_NAME(upper_bound_range, type)(        \
+const type* items, size_t count, type value) {              \
+    if (count == 0) return 0;                               \
+    const type* base = items;                               \
+    while (count > 1) {                                     \
+        size_t half = count / 2;                            \
+        size_t next = (count - half) / 2;                   \
+        DA_PREFETCH(base + next);                           \
+        DA_PREFETCH(base + half + next);                    \
+        base = less(value, base[half])                      \
+            ? base : base + half;                           \
+        count -= half;                                      \
+    }                                                       \
+    return (size_t)(base - items)                           \
+        + (less(value, *base) == 0);                        \
+}                                                           \
+size_t da_lower_bound(type)(                                \
+const struct DA_STRUCT_NAME(type)* da, type value) {        \
+    return DA_FUNC_NAME(lower_bound_range, type)(           \
+        da->items, da->count, value);                       \
+}                                                           \
+size_t da_upper_bound(type)(                                \
+const struct DA_STRUCT_NAME(type)* da, type value) {        \
+    return DA_FUNC_NAME(upper_bound_range, type)(           \
+        da->items, da->count, value);                       \
+}                                                           \
+void da_equal_range(type)(                                  \
+const struct DA_STRUCT_NAME(type)* da, type value,          \
+size_t* first, size_t* last) {                              \
+    *first = da_lower_bound(type)(da, value);               \
+    *last = *first + DA_FUNC_NAME(upper_bound_range, type)( \
+        da->items + *first, da->count - *first, value);     \
+}                                                           \
+int da_binary_search(type)(                                 \
+const struct DA_STRUCT_NAME(type)* da, type value) {        \
+    size_t index = da_lower_bound(type)(da, value);         \
+    return index < da->count                                \
+        && !less(value, da->items[index]);                  \
+}
+
+/**
+ * @brief insert `value` to sorted `da` after all equal items,
+ * shift greater items by one memmove
+ * @param da pointer to sorted dynamic array
+ * @param value value for insert
+ * @return index of inserted item
+ */
+#define da_insert_sorted(type) DA_FUNC_NAME(insert_sorted, type)
+#define DA_DECLARE_INSERT_SORTED(type) \
+size_t da_insert_sorted(type)(         \
+struct DA_STRUCT_NAME(type)* da,       \
+type value)
+/* Need definition of da_upper_bound for passed type */
+#define DA_DEFINE_INSERT_SORTED(type)                 \
+DA_DECLARE_INSERT_SORTED(type) {                      \
+    size_t index = da_upper_bound(type)(da, value);   \
+    DA_GROW(da, da->count + 1);                       \
+    memmove(&da->items[index] + 1, &da->items[index], \
+        sizeof(*da->items) * (da->count - index));    \
+    da->items[index] = value;                         \
+    ++(da->count);                                    \
+    return index;                                     \
+}
+
+/**
+ * @brief merge sorted `values` into sorted `da` in place, merge
+ * goes from the back into spare capacity without scratch buffer,
+ * equal items from `values` placed after items from `da`
+ * @param da pointer to sorted dynamic array
+ * @param values pointer to sorted array of values, not part of `da`
+ * @param values_count count items in `values`
+ */
+#define da_merge_sorted_many(type) DA_FUNC_NAME(merge_sorted_many, type)
+#define DA_DECLARE_MERGE_SORTED_MANY(type) \
+void da_merge_sorted_many(type)(           \
+struct DA_STRUCT_NAME(type)* da,           \
+const type* values,                        \
+size_t values_count)
+/**
+ * `less` - macro or function as `less(a, b)`, where `a` and `b`
+ * is values of type `type`, return non-zero if `a` less than `b`
+ */
+#define DA_DEFINE_MERGE_SORTED_MANY(type, less)             \
+DA_DECLARE_MERGE_SORTED_MANY(type) {                        \
+    DA_GROW(da, da->count + values_count);                  \
+    size_t i = da->count, j = values_count;                 \
+    type* out = da->items + da->count + values_count;       \
+    /* items of `da` before `out` stay in place */          \
+    while (j > 0) {                                         \
+        if (i > 0 && less(values[j - 1], da->items[i - 1])) \
+            *--out = da->items[--i];                        \
+        else                                                \
+            *--out = values[--j];                           \
+    }                                                       \
+    da->count += values_count;                              \
+}
+
+#ifdef DA_X86_SIMD
+
+/**
+ * SIMD kernels for search of value with size `bits`/8 bytes,
+ * `isa` - kernel suffix, `isa_name` - instruction set for compiler,
+ * mask from `movemask` has bit per byte, for implementation
+ */
+#define DA_IMPL_BYTEMASK_KERNELS(isa, isa_name, vec, bits,            \
+    loadu, set1, cmpeq, movemask)                                     \
+static inline __attribute__((target(isa_name)))                       \
+size_t da_impl_find_##bits##_##isa(                                   \
+const void* items, size_t count, uint##bits##_t value) {              \
+    const char* bytes = items;                                        \
+    const size_t lanes = sizeof(vec) / (bits / 8);                    \
+    const vec needle = set1(value);                                   \
+    size_t i = 0;                                                     \
+    for (; i + lanes <= count; i += lanes) {                          \
+        unsigned mask = (unsigned)movemask(cmpeq(                     \
+            loadu((const vec*)(bytes + i * (bits / 8))), needle));    \
+        if (mask != 0)                                                \
+            return i + (size_t)__builtin_ctz(mask) / (bits / 8);      \
+    }                                                                 \
+    for (; i < count; ++i) {                                          \
+        uint##bits##_t item;                                          \
+        memcpy(&item, bytes + i * (bits / 8), bits / 8);              \
+        if (item == value) return i;                                  \
+    }                                                                 \
+    return count;                                                     \
+}                                                                     \
+static inline __attribute__((target(isa_name)))                       \
+size_t da_impl_count_##bits##_##isa(                                  \
+const void* items, size_t count, uint##bits##_t value) {              \
+    const char* bytes = items;                                        \
+    const size_t lanes = sizeof(vec) / (bits / 8);                    \
+    const vec needle = set1(value);                                   \
+    size_t i = 0, found = 0;                                          \
+    for (; i + lanes <= count; i += lanes)                            \
+        found += (size_t)__builtin_popcount((unsigned)movemask(cmpeq( \
+            loadu((const vec*)(bytes + i * (bits / 8))), needle)));   \
+    found /= bits / 8;                                                \
+    for (; i < count; ++i) {                                          \
+        uint##bits##_t item;                                          \
+        memcpy(&item, bytes + i * (bits / 8), bits / 8);              \
+        found += item == value;                                       \
+    }                                                                 \
+    return found;                                                     \
+}
+
+/**
+ * AVX-512 kernels for search of value with size `bits`/8 bytes,
+ * mask from `cmpeq` has bit per item, for implementation
+ */
+#define DA_IMPL_AVX512_KERNELS(isa_name, bits, set1, cmpeq)       \
+static inline __attribute__((target(isa_name)))                   \
+size_t da_impl_find_##bits##_avx512(                              \
+const void* items, size_t count, uint##bits##_t value) {          \
+    const char* bytes = items;                                    \
+    const size_t lanes = sizeof(__m512i) / (bits / 8);            \
+    const __m512i needle = set1(value);                           \
+    size_t i = 0;                                                 \
+    for (; i + lanes <= count; i += lanes) {                      \
+        uint64_t mask = cmpeq(_mm512_loadu_si512(                 \
+            bytes + i * (bits / 8)), needle);                     \
+        if (mask != 0)                                            \
+            return i + (size_t)__builtin_ctzll(mask);             \
+    }                                                             \
+    for (; i < count; ++i) {                                      \
+        uint##bits##_t item;                                      \
+        memcpy(&item, bytes + i * (bits / 8), bits / 8);          \
+        if (item == value) return i;                              \
+    }                                                             \
+    return count;                                                 \
+}                                                                 \
+static inline __attribute__((target(isa_name)))                   \
+size_t da_impl_count_##bits##_avx512(                             \
+const void* items, size_t count, uint##bits##_t value) {          \
+    const char* bytes = items;                                    \
+    const size_t lanes = sizeof(__m512i) / (bits / 8);            \
+    const __m512i needle = set1(value);                           \
+    size_t i = 0, found = 0;                                      \
+    for (; i + lanes <= count; i += lanes)                        \
+        found += (size_t)__builtin_popcountll(cmpeq(              \
+            _mm512_loadu_si512(bytes + i * (bits / 8)), needle)); \
+    for (; i < count; ++i) {                                      \
+        uint##bits##_t item;                                      \
+        memcpy(&item, bytes + i * (bits / 8), bits / 8);          \
+        found += item == value;                                   \
+    }                                                             \
+    return found;                                                 \
+}
+
+/* SSE2 has no 64-bit compare: both 32-bit halves must be equal */
+static inline __attribute__((target("sse2")))
+__m128i da_impl_mm_cmpeq_epi64(__m128i a, __m128i b) {
+    __m128i eq = _mm_cmpeq_epi32(a, b);
+    return _mm_and_si128(eq, _mm_shuffle_epi32(eq, 0xB1));
+}
+
+DA_IMPL_BYTEMASK_KERNELS(sse2, "sse2", __m128i, 8,
+    _mm_loadu_si128, _mm_set1_epi8, _mm_cmpeq_epi8, _mm_movemask_epi8)
+DA_IMPL_BYTEMASK_KERNELS(sse2, "sse2", __m128i, 16,
+    _mm_loadu_si128, _mm_set1_epi16, _mm_cmpeq_epi16, _mm_movemask_epi8)
+DA_IMPL_BYTEMASK_KERNELS(sse2, "sse2", __m128i, 32,
+    _mm_loadu_si128, _mm_set1_epi32, _mm_cmpeq_epi32, _mm_movemask_epi8)
+DA_IMPL_BYTEMASK_KERNELS(sse2, "sse2", __m128i, 64,
+    _mm_loadu_si128, _mm_set1_epi64x, da_impl_mm_cmpeq_epi64,
+    _mm_movemask_epi8)
+DA_IMPL_BYTEMASK_KERNELS(avx2, "avx2", __m256i, 8,
+    _mm256_loadu_si256, _mm256_set1_epi8, _mm256_cmpeq_epi8,
+    _mm256_movemask_epi8)
+DA_IMPL_BYTEMASK_KERNELS(avx2, "avx2", __m256i, 16,
+    _mm256_loadu_si256, _mm256_set1_epi16, _mm256_cmpeq_epi16,
+    _mm256_movemask_epi8)
+DA_IMPL_BYTEMASK_KERNELS(avx2, "avx2", __m256i, 32,
+    _mm256_loadu_si256, _mm256_set1_epi32, _mm256_cmpeq_epi32,
+    _mm256_movemask_epi8)
+DA_IMPL_BYTEMASK_KERNELS(avx2, "avx2", __m256i, 64,
+    _mm256_loadu_si256, _mm256_set1_epi64x, _mm256_cmpeq_epi64,
+    _mm256_movemask_epi8)
+DA_IMPL_AVX512_KERNELS("avx512bw", 8,
+    _mm512_set1_epi8, _mm512_cmpeq_epi8_mask)
+DA_IMPL_AVX512_KERNELS("avx512bw", 16,
+    _mm512_set1_epi16, _mm512_cmpeq_epi16_mask)
+DA_IMPL_AVX512_KERNELS("avx512f", 32,
+    _mm512_set1_epi32, _mm512_cmpeq_epi32_mask)
+DA_IMPL_AVX512_KERNELS("avx512f", 64,
+    _mm512_set1_epi64, _mm512_cmpeq_epi64_mask)
+
+/* Levels of instruction set, for implementation */
+enum {
+    DA_IMPL_SIMD_NONE,
+    DA_IMPL_SIMD_SSE2,
+    DA_IMPL_SIMD_AVX2,
+    DA_IMPL_SIMD_AVX512F,
+    DA_IMPL_SIMD_AVX512BW
+};
+
+/**
+ * Best supported instruction set by CPUID, for implementation,
+ * cached level is atomic if threads enabled: pool workers may ask
+ * first time together, all of them store same value
+ */
+static inline int da_impl_simd_level(void) {
+#ifdef DA_ENABLE_THREADS
+    static _Atomic int cached = -1;
+    int level = atomic_load_explicit(&cached, memory_order_relaxed);
+#else
+    static int cached = -1;
+    int level = cached;
+#endif
+    if (level < 0) {
+        __builtin_cpu_init();
+        level = __builtin_cpu_supports("avx512bw") ? DA_IMPL_SIMD_AVX512BW
+            : __builtin_cpu_supports("avx512f") ? DA_IMPL_SIMD_AVX512F
+            : __builtin_cpu_supports("avx2") ? DA_IMPL_SIMD_AVX2
+            : __builtin_cpu_supports("sse2") ? DA_IMPL_SIMD_SSE2
+            : DA_IMPL_SIMD_NONE;
+#ifdef DA_ENABLE_THREADS
+        atomic_store_explicit(&cached, level, memory_order_relaxed);
+#else
+        cached = level;
+#endif
+    }
+    return level;
+}
+
+/* Choose kernel `op` (find or count) for `bits`-wide value,
+ * for implementation */
+#define DA_IMPL_DISPATCH(op, bits, avx512_level)                    \
+static inline size_t da_impl_##op##_##bits(                         \
+const void* items, size_t count, uint##bits##_t value) {            \
+    int level = da_impl_simd_level();                               \
+    if (level >= avx512_level)                                      \
+        return da_impl_##op##_##bits##_avx512(items, count, value); \
+    if (level >= DA_IMPL_SIMD_AVX2)                                 \
+        return da_impl_##op##_##bits##_avx2(items, count, value);   \
+    return da_impl_##op##_##bits##_sse2(items, count, value);       \
+}
+
+DA_IMPL_DISPATCH(find,  8,  DA_IMPL_SIMD_AVX512BW)
+DA_IMPL_DISPATCH(find,  16, DA_IMPL_SIMD_AVX512BW)
+DA_IMPL_DISPATCH(find,  32, DA_IMPL_SIMD_AVX512F)
+DA_IMPL_DISPATCH(find,  64, DA_IMPL_SIMD_AVX512F)
+DA_IMPL_DISPATCH(count, 8,  DA_IMPL_SIMD_AVX512BW)
+DA_IMPL_DISPATCH(count, 16, DA_IMPL_SIMD_AVX512BW)
+DA_IMPL_DISPATCH(count, 32, DA_IMPL_SIMD_AVX512F)
+DA_IMPL_DISPATCH(count, 64, DA_IMPL_SIMD_AVX512F)
+
+/**
+ * Return result of SIMD kernel `op` for `type` if it is integer
+ * or pointer with size 1, 2, 4 or 8 bytes, for implementation
+ */
+#define DA_IMPL_SIMD_RETURN(op, type, items, count, value) \
+if (DA_IMPL_IS_SIMD_SCALAR(type)                           \
+&& da_impl_simd_level() != DA_IMPL_SIMD_NONE)              \
+switch (sizeof(type)) {                                    \
+case 1: { uint8_t bits; memcpy(&bits, &(value), 1);        \
+    return da_impl_##op##_8(items, count, bits); }         \
+case 2: { uint16_t bits; memcpy(&bits, &(value), 2);       \
+    return da_impl_##op##_16(items, count, bits); }        \
+case 4: { uint32_t bits; memcpy(&bits, &(value), 4);       \
+    return da_impl_##op##_32(items, count, bits); }        \
+case 8: { uint64_t bits; memcpy(&bits, &(value), 8);       \
+    return da_impl_##op##_64(items, count, bits); }        \
+}
+
+#else
+#define DA_IMPL_SIMD_RETURN(op, type, items, count, value)
+#endif // DA_X86_SIMD
+
+/**
+ * Bitwise comparable scalar (not floating point): by user promise
+ * of DA_SIMD_INTEGERS, by _Generic in C11, otherwise SIMD is off,
+ * for implementation
+ */
+#if defined(DA_SIMD_INTEGERS)
+#define DA_IMPL_IS_SIMD_SCALAR(type) 1
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define DA_IMPL_IS_SIMD_SCALAR(type) _Generic((type)0, \
+    float: 0, double: 0, long double: 0, default: 1)
+#else
+#define DA_IMPL_IS_SIMD_SCALAR(type) 0
+#endif
+
+/**
+ * @brief find index of first item equal to `value`
+ * or `da.count` if not exist
+ * @param da pointer to dynamic array
+ * @param value value for search
+ */
+#define da_find(type) DA_FUNC_NAME(find, type)
+#define DA_DECLARE_FIND(type)          \
+size_t da_find(type)(                  \
+const struct DA_STRUCT_NAME(type)* da, \
+type value)
+/**
+ * Items compared by `==`, so `type` must be scalar,
+ * for integers and pointers used SIMD kernels (C11 or DA_SIMD_INTEGERS)
+ */
+#define DA_DEFINE_FIND(type)                 \
+DA_DECLARE_FIND(type) {                      \
+    DA_IMPL_SIMD_RETURN(find, type,          \
+        da->items, da->count, value)         \
+    DA_FORLOOP(i, 0, da->count)              \
+        if (da->items[i] == value) return i; \
+    return da->count;                        \
+}
+
+/**
+ * @brief count items equal to `value`
+ * @param da pointer to dynamic array
+ * @param value value for search
+ */
+#define da_count(type) DA_FUNC_NAME(count, type)
+#define DA_DECLARE_COUNT(type)         \
+size_t da_count(type)(                 \
+const struct DA_STRUCT_NAME(type)* da, \
+type value)
+/**
+ * Items compared by `==`, so `type` must be scalar,
+ * for integers and pointers used SIMD kernels (C11 or DA_SIMD_INTEGERS)
+ */
+#define DA_DEFINE_COUNT(type)           \
+DA_DECLARE_COUNT(type) {                \
+    DA_IMPL_SIMD_RETURN(count, type,    \
+        da->items, da->count, value)    \
+    size_t found = 0;                   \
+    DA_FORLOOP(i, 0, da->count)         \
+        found += da->items[i] == value; \
+    return found;                       \
+}
+
+/**
+ * @brief check that `da` contains `value`
+ * @param da pointer to dynamic array
+ * @param value value for search
+ * @return non-zero if `value` found
+ */
+#define da_contains(type) DA_FUNC_NAME(contains, type)
+#define DA_DECLARE_CONTAINS(type)      \
+int da_contains(type)(                 \
+const struct DA_STRUCT_NAME(type)* da, \
+type value)
+/* Need definition of da_find for passed type */
+#define DA_DEFINE_CONTAINS(type)                 \
+DA_DECLARE_CONTAINS(type) {                      \
+    return da_find(type)(da, value) < da->count; \
+}
+
+/* Count of independent accumulators in reductions, for implementation */
+#define DA_REDUCE_LANES 8
+/* Count of items summed without split in pairwise sum, for implementation */
+#define DA_PAIRWISE_BLOCK 128
+
+/**
+ * @brief sum of all items (0 for empty `da`), accumulated
+ * in `type`, so for small integers overflow is possible
+ * @param da pointer to dynamic array
+ */
+#define da_sum(type) DA_FUNC_NAME(sum, type)
+/**
+ * @brief minimal item of non-empty `da`
+ * @param da pointer to dynamic array
+ */
+#define da_min(type) DA_FUNC_NAME(min, type)
+/**
+ * @brief maximal item of non-empty `da`
+ * @param da pointer to dynamic array
+ */
+#define da_max(type) DA_FUNC_NAME(max, type)
+/**
+ * @brief minimal and maximal items of non-empty `da`
+ * @param da pointer to dynamic array
+ * @param min pointer to minimal value
+ * @param max pointer to maximal value
+ */
+#define da_minmax(type) DA_FUNC_NAME(minmax, type)
+/**
+ * @brief index of first minimal item of non-empty `da`
+ * @param da pointer to dynamic array
+ */
+#define da_argmin(type) DA_FUNC_NAME(argmin, type)
+/**
+ * @brief index of first maximal item of non-empty `da`
+ * @param da pointer to dynamic array
+ */
+#define da_argmax(type) DA_FUNC_NAME(argmax, type)
+#define DA_DECLARE_REDUCE(type)                                \
+type da_sum(type)(const struct DA_STRUCT_NAME(type)* da);      \
+type da_min(type)(const struct DA_STRUCT_NAME(type)* da);      \
+type da_max(type)(const struct DA_STRUCT_NAME(type)* da);      \
+void da_minmax(type)(const struct DA_STRUCT_NAME(type)* da,    \
+type* min, type* max);                                         \
+size_t da_argmin(type)(const struct DA_STRUCT_NAME(type)* da); \
+size_t da_argmax(type)(const struct DA_STRUCT_NAME(type)* da)
+/**
+ * `type` must be arithmetic, loops hold DA_REDUCE_LANES
+ * independent accumulators, so compiler can keep them
+ * in SIMD registers, comparisons made by `<`
+ */
+#define DA_DEFINE_REDUCE(type)                                     \
+static type DA_FUNC_NAME(sum_range, type)(                         \
+const type* items, size_t count) {                                 \
+    type acc[DA_REDUCE_LANES] = {0};                               \
+    size_t i = 0;                                                  \
+    for (; i + DA_REDUCE_LANES <= count; i += DA_REDUCE_LANES)     \
+        DA_FORLOOP(k, 0, DA_REDUCE_LANES)                          \
+            acc[k] += items[i + k];                                \
+    for (; i < count; ++i)                                         \
+        acc[i % DA_REDUCE_LANES] += items[i];                      \
+    for (size_t w = DA_REDUCE_LANES / 2; w > 0; w /= 2)            \
+        DA_FORLOOP(k, 0, w)                                        \
+            acc[k] += acc[k + w];                                  \
+    return acc[0];                                                 \
+}                                                                  \
+type da_sum(type)(const struct DA_STRUCT_NAME(type)* da) {         \
+    return DA_FUNC_NAME(sum_range, type)(da->items, da->count);    \
+}                                                                  \
+void da_minmax(type)(const struct DA_STRUCT_NAME(type)* da,        \
+type* min, type* max) {                                            \
+    assert(da->count > 0 && "Empty array");                        \
+    type lo[DA_REDUCE_LANES], hi[DA_REDUCE_LANES];                 \
+    DA_FORLOOP(k, 0, DA_REDUCE_LANES)                              \
+        lo[k] = hi[k] = da->items[0];                              \
+    size_t i = 0;                                                  \
+    for (; i + DA_REDUCE_LANES <= da->count; i += DA_REDUCE_LANES) \
+        DA_FORLOOP(k, 0, DA_REDUCE_LANES) {                        \
+            type item = da->items[i + k];                          \
+            lo[k] = item < lo[k] ? item : lo[k];                   \
+            hi[k] = hi[k] < item ? item : hi[k];                   \
+        }                                                          \
+    for (; i < da->count; ++i) {                                   \
+        type item = da->items[i];                                  \
+        lo[0] = item < lo[0] ? item : lo[0];                       \
+        hi[0] = hi[0] < item ? item : hi[0];                       \
+    }                                                              \
+    DA_FORLOOP(k, 1, DA_REDUCE_LANES) {                            \
+        lo[0] = lo[k] < lo[0] ? lo[k] : lo[0];                     \
+        hi[0] = hi[0] < hi[k] ? hi[k] : hi[0];                     \
+    }                                                              \
+    if (min != NULL) *min = lo[0];                                 \
+    if (max != NULL) *max = hi[0];                                 \
+}                                                                  \
+type da_min(type)(const struct DA_STRUCT_NAME(type)* da) {         \
+    type min;                                                      \
+    da_minmax(type)(da, &min, NULL);                               \
+    return min;                                                    \
+}                                                                  \
+type da_max(type)(const struct DA_STRUCT_NAME(type)* da) {         \
+    type max;                                                      \
+    da_minmax(type)(da, NULL, &max);                               \
+    return max;                                                    \
+}                                                                  \
+DA_IMPL_DEFINE_ARGBEST(type, argmin, <)                            \
+DA_IMPL_DEFINE_ARGBEST(type, argmax, >)
+
+/* Define argmin or argmax by comparison `cmp`, for implementation */
+#define DA_IMPL_DEFINE_ARGBEST(type, name, cmp)                    \
+size_t da_##name(type)(const struct DA_STRUCT_NAME(type)* da) {    \
+    assert(da->count > 0 && "Empty array");                        \
+    type best[DA_REDUCE_LANES];                                    \
+    size_t index[DA_REDUCE_LANES];                                 \
+    DA_FORLOOP(k, 0, DA_REDUCE_LANES) {                            \
+        best[k] = da->items[0];                                    \
+        index[k] = 0;                                              \
+    }                                                              \
+    size_t i = 0;                                                  \
+    for (; i + DA_REDUCE_LANES <= da->count; i += DA_REDUCE_LANES) \
+        DA_FORLOOP(k, 0, DA_REDUCE_LANES) {                        \
+            type item = da->items[i + k];                          \
+            int better = item cmp best[k];                         \
+            best[k] = better ? item : best[k];                     \
+            index[k] = better ? i + k : index[k];                  \
+        }                                                          \
+    for (; i < da->count; ++i)                                     \
+        if (da->items[i] cmp best[0]) {                            \
+            best[0] = da->items[i];                                \
+            index[0] = i;                                          \
+        }                                                          \
+    /* equal values from different lanes: first index wins */      \
+    DA_FORLOOP(k, 1, DA_REDUCE_LANES)                              \
+        if (best[k] cmp best[0] || (!(best[0] cmp best[k])         \
+        && index[k] < index[0])) {                                 \
+            best[0] = best[k];                                     \
+            index[0] = index[k];                                   \
+        }                                                          \
+    return index[0];                                               \
+}
+
+/**
+ * @brief sum of all items by pairwise summation, error grows
+ * as O(log n) instead of O(n) for floating point types
+ * @param da pointer to dynamic array
+ */
+#define da_sum_pairwise(type) DA_FUNC_NAME(sum_pairwise, type)
+#define DA_DECLARE_SUM_PAIRWISE(type) \
+type da_sum_pairwise(type)(           \
+const struct DA_STRUCT_NAME(type)* da)
+/* Need definition of da_sum (DA_DEFINE_REDUCE) for passed type */
+#define DA_DEFINE_SUM_PAIRWISE(type)                           \
+static type DA_FUNC_NAME(sum_pairwise_range, type)(            \
+const type* items, size_t count) {                             \
+    if (count <= DA_PAIRWISE_BLOCK)                            \
+        return DA_FUNC_NAME(sum_range, type)(items, count);    \
+    size_t half = count / 2;                                   \
+    return DA_FUNC_NAME(sum_pairwise_range, type)(items, half) \
+        + DA_FUNC_NAME(sum_pairwise_range, type)(              \
+            items + half, count - half);                       \
+}                                                              \
+DA_DECLARE_SUM_PAIRWISE(type) {                                \
+    return DA_FUNC_NAME(sum_pairwise_range, type)(             \
+        da->items, da->count);                                 \
+}
+
+/**
+ * @brief sum of all items by Kahan compensated summation, error
+ * not depend of count items for floating point types (do not
+ * compile with -ffast-math, it drops compensation)
+ * @param da pointer to dynamic array
+ */
+#define da_sum_kahan(type) DA_FUNC_NAME(sum_kahan, type)
+#define DA_DECLARE_SUM_KAHAN(type) \
+type da_sum_kahan(type)(           \
+const struct DA_STRUCT_NAME(type)* da)
+#define DA_DEFINE_SUM_KAHAN(type)                                  \
+DA_DECLARE_SUM_KAHAN(type) {                                       \
+    type sum[DA_REDUCE_LANES] = {0}, err[DA_REDUCE_LANES] = {0};   \
+    size_t i = 0;                                                  \
+    for (; i + DA_REDUCE_LANES <= da->count; i += DA_REDUCE_LANES) \
+        DA_FORLOOP(k, 0, DA_REDUCE_LANES) {                        \
+            type item = da->items[i + k] - err[k];                 \
+            type next = sum[k] + item;                             \
+            err[k] = (next - sum[k]) - item;                       \
+            sum[k] = next;                                         \
+        }                                                          \
+    for (; i < da->count; ++i) {                                   \
+        type item = da->items[i] - err[0];                         \
+        type next = sum[0] + item;                                 \
+        err[0] = (next - sum[0]) - item;                           \
+        sum[0] = next;                                             \
+    }                                                              \
+    /* lanes summed with compensation too */                       \
+    DA_FORLOOP(k, 1, DA_REDUCE_LANES) {                            \
+        type item = sum[k] - (err[0] + err[k]);                    \
+        type next = sum[0] + item;                                 \
+        err[0] = (next - sum[0]) - item;                           \
+        sum[0] = next;                                             \
+    }                                                              \
+    return sum[0];                                                 \
+}
+
+#ifdef DA_X86_SIMD
+
+/**
+ * SSE2 in-register scan of `bits`-wide integers: lanes summed with
+ * lanes shifted by 4 and 8 bytes, then carry of previous vector
+ * added, `exclusive` subtract item itself, return carry for next
+ * items, for implementation
+ */
+#define DA_IMPL_SCAN_KERNEL(bits, add, set1, broadcast_last)     \
+static inline __attribute__((target("sse2")))                    \
+uint##bits##_t da_impl_scan_##bits(void* out, const void* in,    \
+size_t count, uint##bits##_t carry, int exclusive) {             \
+    const size_t lanes = sizeof(__m128i) / (bits / 8);           \
+    char* dst = out;                                             \
+    const char* src = in;                                        \
+    __m128i acc = set1(carry);                                   \
+    size_t i = 0;                                                \
+    for (; i + lanes <= count; i += lanes) {                     \
+        __m128i item = _mm_loadu_si128(                          \
+            (const __m128i*)(src + i * (bits / 8)));             \
+        __m128i sum = item;                                      \
+        if (bits == 32)                                          \
+            sum = add(sum, _mm_slli_si128(sum, 4));              \
+        sum = add(sum, _mm_slli_si128(sum, 8));                  \
+        sum = add(sum, acc);                                     \
+        acc = broadcast_last(sum);                               \
+        if (exclusive) sum = _mm_sub_epi##bits(sum, item);       \
+        _mm_storeu_si128((__m128i*)(dst + i * (bits / 8)), sum); \
+    }                                                            \
+    memcpy(&carry, &acc, bits / 8);                              \
+    for (; i < count; ++i) {                                     \
+        uint##bits##_t item;                                     \
+        memcpy(&item, src + i * (bits / 8), bits / 8);           \
+        carry += item;                                           \
+        item = exclusive ? carry - item : carry;                 \
+        memcpy(dst + i * (bits / 8), &item, bits / 8);           \
+    }                                                            \
+    return carry;                                                \
+}
+
+#define DA_IMPL_MM_BROADCAST_LAST_32(x) _mm_shuffle_epi32(x, 0xFF)
+#define DA_IMPL_MM_BROADCAST_LAST_64(x) _mm_shuffle_epi32(x, 0xEE)
+
+DA_IMPL_SCAN_KERNEL(32, _mm_add_epi32, _mm_set1_epi32,
+    DA_IMPL_MM_BROADCAST_LAST_32)
+DA_IMPL_SCAN_KERNEL(64, _mm_add_epi64, _mm_set1_epi64x,
+    DA_IMPL_MM_BROADCAST_LAST_64)
+
+/**
+ * Return carry from SIMD scan kernel if `type` is
+ * integer with size 4 or 8 bytes, for implementation
+ */
+#define DA_IMPL_SIMD_SCAN_RETURN(type, out, in, count, carry, exclusive) \
+if (DA_IMPL_IS_SIMD_SCALAR(type)                                         \
+&& da_impl_simd_level() != DA_IMPL_SIMD_NONE)                            \
+switch (sizeof(type)) {                                                  \
+case 4: { uint32_t bits; memcpy(&bits, &(carry), 4);                     \
+    bits = da_impl_scan_32(out, in, count, bits, exclusive);             \
+    memcpy(&(carry), &bits, 4); return carry; }                          \
+case 8: { uint64_t bits; memcpy(&bits, &(carry), 8);                     \
+    bits = da_impl_scan_64(out, in, count, bits, exclusive);             \
+    memcpy(&(carry), &bits, 8); return carry; }                          \
+}
+
+#else
+#define DA_IMPL_SIMD_SCAN_RETURN(type, out, in, count, carry, exclusive)
+#endif // DA_X86_SIMD
+
+/**
+ * @brief write to `dst` inclusive prefix sums of `src`:
+ * dst[i] = src[0] + ... + src[i], `dst` reserve place once,
+ * old items of `dst` destroyed, `dst` may be equal `src`
+ * for scan in place, then items only change values
+ * @param dst pointer to destination dynamic array
+ * @param src pointer to source dynamic array
+ */
+#define da_inclusive_scan(type) DA_FUNC_NAME(inclusive_scan, type)
+/**
+ * @brief write to `dst` exclusive prefix sums of `src`:
+ * dst[0] = 0, dst[i] = src[0] + ... + src[i-1], `dst` reserve
+ * place once, old items of `dst` destroyed, `dst` may be
+ * equal `src` for scan in place, then items only change values
+ * @param dst pointer to destination dynamic array
+ * @param src pointer to source dynamic array
+ */
+#define da_exclusive_scan(type) DA_FUNC_NAME(exclusive_scan, type)
+#define DA_DECLARE_SCAN(type)            \
+void da_inclusive_scan(type)(            \
+struct DA_STRUCT_NAME(type)* dst,        \
+const struct DA_STRUCT_NAME(type)* src); \
+void da_exclusive_scan(type)(            \
+struct DA_STRUCT_NAME(type)* dst,        \
+const struct DA_STRUCT_NAME(type)* src)
+/**
+ * `type` must be arithmetic, for integers with size
+ * 4 or 8 bytes used SSE2 kernel (C11 or DA_SIMD_INTEGERS)
+ */
+#define DA_DEFINE_SCAN(type)                                         \
+static type DA_FUNC_NAME(scan_range, type)(type* out,                \
+const type* in, size_t count, type carry, int exclusive) {           \
+    DA_IMPL_SIMD_SCAN_RETURN(type, out, in, count, carry, exclusive) \
+    if (exclusive)                                                   \
+        DA_FORLOOP(i, 0, count) {                                    \
+            type item = in[i];                                       \
+            out[i] = carry;                                          \
+            carry += item;                                           \
+        }                                                            \
+    else                                                             \
+        DA_FORLOOP(i, 0, count)                                      \
+            out[i] = carry += in[i];                                 \
+    return carry;                                                    \
+}                                                                    \
+static void DA_FUNC_NAME(scan_prepare, type)(                        \
+struct DA_STRUCT_NAME(type)* dst,                                    \
+const struct DA_STRUCT_NAME(type)* src) {                            \
+    if (dst != src && dst->dtor != NULL)                             \
+        DA_FOREACH(type, item, dst)                                  \
+            dst->dtor(item);                                         \
+    DA_RESERVE(dst, src->count);                                     \
+    dst->count = src->count;                                         \
+}                                                                    \
+void da_inclusive_scan(type)(                                        \
+struct DA_STRUCT_NAME(type)* dst,                                    \
+const struct DA_STRUCT_NAME(type)* src) {                            \
+    DA_FUNC_NAME(scan_prepare, type)(dst, src);                      \
+    DA_FUNC_NAME(scan_range, type)(                                  \
+        dst->items, src->items, src->count, 0, 0);                   \
+}                                                                    \
+void da_exclusive_scan(type)(                                        \
+struct DA_STRUCT_NAME(type)* dst,                                    \
+const struct DA_STRUCT_NAME(type)* src) {                            \
+    DA_FUNC_NAME(scan_prepare, type)(dst, src);                      \
+    DA_FUNC_NAME(scan_range, type)(                                  \
+        dst->items, src->items, src->count, 0, 1);                   \
+}
+
+/**
+ * @brief append to `dst` results of `fn` for every item of `src`,
+ * place for all results reserved once, items written by cursor
+ * without capacity check per item
+ * @param dst pointer to destination dynamic array
+ * @param src pointer to source dynamic array, not equal `dst`
+ * @param fn function as `dst_type fn(const src_type* item, void* ctx)`
+ * @param ctx user data passed to `fn`
+ */
+#define da_map(src_type, dst_type) \
+DA_FUNC_NAME(map, src_type ## _to_ ## dst_type)
+#define DA_DECLARE_MAP(src_type, dst_type)  \
+void da_map(src_type, dst_type)(            \
+struct DA_STRUCT_NAME(dst_type)* dst,       \
+const struct DA_STRUCT_NAME(src_type)* src, \
+dst_type (*fn)(const src_type*, void*),     \
+void* ctx)
+#define DA_DEFINE_MAP(src_type, dst_type)     \
+DA_DECLARE_MAP(src_type, dst_type) {          \
+    DA_RESERVE(dst, dst->count + src->count); \
+    dst_type* out = dst->items + dst->count;  \
+    DA_FORLOOP(i, 0, src->count)              \
+        out[i] = fn(&src->items[i], ctx);     \
+    dst->count += src->count;                 \
+}
+
+/**
+ * @brief append to `dst` items of `src` for which `pred` return
+ * non-zero, place for all items of `src` reserved once and items
+ * written by cursor without branch, after that unused capacity
+ * greater than growth policy give back to allocator,
+ * if `dst` equal `src` filter in place and destroy dropped items
+ * @param dst pointer to destination dynamic array
+ * @param src pointer to source dynamic array
+ * @param pred function as `int pred(const type* item, void* ctx)`
+ * @param ctx user data passed to `pred`
+ */
+#define da_filter(type) DA_FUNC_NAME(filter, type)
+#define DA_DECLARE_FILTER(type)         \
+void da_filter(type)(                   \
+struct DA_STRUCT_NAME(type)* dst,       \
+const struct DA_STRUCT_NAME(type)* src, \
+int (*pred)(const type*, void*),        \
+void* ctx)
+#define DA_DEFINE_FILTER(type)                      \
+DA_DECLARE_FILTER(type) {                           \
+    int in_place = dst == src;                      \
+    size_t count = src->count;                      \
+    if (in_place) dst->count = 0;                   \
+    else DA_RESERVE(dst, dst->count + count);       \
+    type* out = dst->items + dst->count;            \
+    DA_FORLOOP(i, 0, count) {                       \
+        int keep = pred(&src->items[i], ctx) != 0;  \
+        if (!keep && in_place && dst->dtor != NULL) \
+            dst->dtor(&dst->items[i]);              \
+        *out = src->items[i];                       \
+        out += keep;                                \
+    }                                               \
+    dst->count = (size_t)(out - dst->items);        \
+    if (dst->count > 0 && dst->capacity             \
+    > dst->count + (dst->count + 1) / 2) {          \
+        dst->capacity = dst->count;                 \
+        dst->items = realloc(dst->items,            \
+            dst->capacity * sizeof(*dst->items));   \
+        assert(dst->items != NULL && "Not memory"); \
+    }                                               \
+}
+
+/* Size of segment `k` of segmented array */
+#define DA_SEGMENT_SIZE(k) ((size_t)DA_SEGMENT_BASE << (k))
+/* Count of segments enough for any size_t index */
+#define DA_SEGMENT_COUNT (sizeof(size_t) * 8)
+
+/* Index of highest set bit of non-zero `x`, for implementation */
+static inline size_t da_impl_log2(size_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return sizeof(unsigned long long) * 8 - 1
+        - (size_t)__builtin_clzll(x);
+#else
+    size_t log = 0;
+    while (x >>= 1) ++log;
+    return log;
+#endif
+}
+
+/**
+ * Segmented array: segment `k` has DA_SEGMENT_BASE * 2^k items,
+ * segments never move, so pointers to items stay valid
+ * until free, initialized by {0}
+ */
+#define DA_SEGMENTED_STRUCT_NAME(type) da_segmented_struct_ ## type
+#define DA_DECLARE_SEGMENTED_STRUCT(type, name) \
+typedef struct DA_SEGMENTED_STRUCT_NAME(type) name;
+#define DA_DEFINE_SEGMENTED_STRUCT(type, name) \
+DA_DECLARE_SEGMENTED_STRUCT(type, name)        \
+struct DA_SEGMENTED_STRUCT_NAME(type) {        \
+    type*  segments[DA_SEGMENT_COUNT];         \
+    size_t count;                              \
+    void (*dtor)(type*);                       \
+};
+
+/* For loop macros over segmented array, `break` leave only segment */
+#define DA_SEGMENTED_FOREACH(type, item_ptr_name, sa)                 \
+for (size_t item_ptr_name##_seg = 0,                                  \
+    item_ptr_name##_left = (sa)->count;                               \
+    item_ptr_name##_left > 0;                                         \
+    item_ptr_name##_left -= item_ptr_name##_left                      \
+        < DA_SEGMENT_SIZE(item_ptr_name##_seg) ? item_ptr_name##_left \
+        : DA_SEGMENT_SIZE(item_ptr_name##_seg),                       \
+    ++item_ptr_name##_seg)                                            \
+for (type* item_ptr_name = (sa)->segments[item_ptr_name##_seg],       \
+    *item_ptr_name##_end = item_ptr_name + (item_ptr_name##_left      \
+        < DA_SEGMENT_SIZE(item_ptr_name##_seg) ? item_ptr_name##_left \
+        : DA_SEGMENT_SIZE(item_ptr_name##_seg));                      \
+    item_ptr_name < item_ptr_name##_end;                              \
+    ++item_ptr_name)
+
+/* Segment of item `index`, for implementation */
+#define DA_IMPL_SEGMENT_OF(index) \
+da_impl_log2((index) / DA_SEGMENT_BASE + 1)
+/* Offset of item `index` in segment `k`, for implementation */
+#define DA_IMPL_SEGMENT_OFFSET(index, k) \
+((index) + DA_SEGMENT_BASE - DA_SEGMENT_SIZE(k))
+
+/**
+ * @brief pointer to item at `index`, O(1)
+ * @param sa pointer to segmented array
+ * @param index valid index in range [0, `sa.count`)
+ */
+#define da_segmented_at(type) DA_FUNC_NAME(segmented_at, type)
+#define DA_DECLARE_SEGMENTED_AT(type)            \
+type* da_segmented_at(type)(                     \
+const struct DA_SEGMENTED_STRUCT_NAME(type)* sa, \
+size_t index)
+#define DA_DEFINE_SEGMENTED_AT(type)                           \
+DA_DECLARE_SEGMENTED_AT(type) {                                \
+    assert(index < sa->count && "Out of range");               \
+    size_t k = DA_IMPL_SEGMENT_OF(index);                      \
+    return &sa->segments[k][DA_IMPL_SEGMENT_OFFSET(index, k)]; \
+}
+
+/**
+ * @brief add `value` to end of `sa`, if segments is full
+ * allocate next segment, items never move
+ * @param sa pointer to segmented array
+ * @param value value for append
+ * @return pointer to appended item
+ */
+#define da_segmented_append(type) DA_FUNC_NAME(segmented_append, type)
+#define DA_DECLARE_SEGMENTED_APPEND(type)  \
+type* da_segmented_append(type)(           \
+struct DA_SEGMENTED_STRUCT_NAME(type)* sa, \
+type value)
+#define DA_DEFINE_SEGMENTED_APPEND(type)                 \
+DA_DECLARE_SEGMENTED_APPEND(type) {                      \
+    size_t k = DA_IMPL_SEGMENT_OF(sa->count);            \
+    if (sa->segments[k] == NULL) {                       \
+        sa->segments[k] = malloc(                        \
+            DA_SEGMENT_SIZE(k) * sizeof(type));          \
+        assert(sa->segments[k] != NULL && "Not memory"); \
+    }                                                    \
+    type* item = &sa->segments[k][                       \
+        DA_IMPL_SEGMENT_OFFSET(sa->count, k)];           \
+    *item = value;                                       \
+    ++(sa->count);                                       \
+    return item;                                         \
+}
+
+/**
+ * @brief destroy items and free all segments
+ * @param sa pointer to segmented array
+ */
+#define da_segmented_free(type) DA_FUNC_NAME(segmented_free, type)
+#define DA_DECLARE_SEGMENTED_FREE(type) \
+void da_segmented_free(type)(           \
+struct DA_SEGMENTED_STRUCT_NAME(type)* sa)
+#define DA_DEFINE_SEGMENTED_FREE(type)       \
+DA_DECLARE_SEGMENTED_FREE(type) {            \
+    if (sa->dtor != NULL)                    \
+        DA_SEGMENTED_FOREACH(type, item, sa) \
+            sa->dtor(item);                  \
+    DA_FORLOOP(k, 0, DA_SEGMENT_COUNT) {     \
+        free(sa->segments[k]);               \
+        sa->segments[k] = NULL;              \
+    }                                        \
+    sa->count = 0;                           \
+}
+
+/**
+ * Double-ended queue on circular buffer, capacity is power
+ * of two, item `i` at `(head + i) & (capacity - 1)`,
+ * initialized by {0}
+ */
+#define DA_DEQUE_STRUCT_NAME(type) da_deque_struct_ ## type
+#define DA_DECLARE_DEQUE(type, name) \
+typedef struct DA_DEQUE_STRUCT_NAME(type) name;
+#define DA_DEFINE_DEQUE(type, name) \
+DA_DECLARE_DEQUE(type, name)        \
+struct DA_DEQUE_STRUCT_NAME(type) { \
+    type*  items;                   \
+    size_t head;                    \
+    size_t count;                   \
+    size_t capacity;                \
+    void (*dtor)(type*);            \
+};
+
+/* Count of items in first span of deque, for implementation */
+#define DA_IMPL_DEQUE_FIRST(dq)            \
+((dq)->count < (dq)->capacity - (dq)->head \
+    ? (dq)->count : (dq)->capacity - (dq)->head)
+
+/* For loop macros over deque by two spans, `break` leave both spans */
+#define DA_DEQUE_FOREACH(type, item_ptr_name, dq)                     \
+for (size_t item_ptr_name##_span = 0, item_ptr_name##_more = 1;       \
+    item_ptr_name##_more && item_ptr_name##_span < 2;                 \
+    ++item_ptr_name##_span)                                           \
+for (type* item_ptr_name = (item_ptr_name##_more = 0,                 \
+        item_ptr_name##_span == 0                                     \
+        ? (dq)->items + (dq)->head : (dq)->items),                    \
+    *item_ptr_name##_end = item_ptr_name + (item_ptr_name##_span == 0 \
+        ? DA_IMPL_DEQUE_FIRST(dq)                                     \
+        : (dq)->count - DA_IMPL_DEQUE_FIRST(dq));                     \
+    item_ptr_name < item_ptr_name##_end                               \
+        || (item_ptr_name##_more = 1, 0);                             \
+    ++item_ptr_name)
+
+/* Double capacity of deque and unwrap items to begin, for implementation */
+#define DA_IMPL_DEQUE_GROW(type, dq)                                   \
+do {                                                                   \
+    size_t capacity = 1;                                               \
+    while (capacity < DA_DEFAULT_INIT_CAP) capacity <<= 1;             \
+    if ((dq)->capacity > 0) capacity = (dq)->capacity * 2;             \
+    type* items = malloc(capacity * sizeof(type));                     \
+    assert(items != NULL && "Not memory");                             \
+    size_t first = DA_IMPL_DEQUE_FIRST(dq);                            \
+    if (first > 0)                                                     \
+        memcpy(items, (dq)->items + (dq)->head, first * sizeof(type)); \
+    if ((dq)->count > first)                                           \
+        memcpy(items + first, (dq)->items,                             \
+            ((dq)->count - first) * sizeof(type));                     \
+    free((dq)->items);                                                 \
+    (dq)->items = items;                                               \
+    (dq)->head = 0;                                                    \
+    (dq)->capacity = capacity;                                         \
+} while (0)
+
+/**
+ * @brief pointer to item at `index` from front, O(1)
+ * @param dq pointer to deque
+ * @param index valid index in range [0, `dq.count`)
+ */
+#define da_deque_at(type) DA_FUNC_NAME(deque_at, type)
+#define DA_DECLARE_DEQUE_AT(type)            \
+type* da_deque_at(type)(                     \
+const struct DA_DEQUE_STRUCT_NAME(type)* dq, \
+size_t index)
+#define DA_DEFINE_DEQUE_AT(type)                                \
+DA_DECLARE_DEQUE_AT(type) {                                     \
+    assert(index < dq->count && "Out of range");                \
+    return &dq->items[(dq->head + index) & (dq->capacity - 1)]; \
+}
+
+/**
+ * @brief add `value` to end of `dq`, amortized O(1)
+ * @param dq pointer to deque
+ * @param value value for append
+ */
+#define da_deque_push_back(type) DA_FUNC_NAME(deque_push_back, type)
+#define DA_DECLARE_DEQUE_PUSH_BACK(type) \
+void da_deque_push_back(type)(           \
+struct DA_DEQUE_STRUCT_NAME(type)* dq,   \
+type value)
+#define DA_DEFINE_DEQUE_PUSH_BACK(type)                             \
+DA_DECLARE_DEQUE_PUSH_BACK(type) {                                  \
+    if (dq->count == dq->capacity)                                  \
+        DA_IMPL_DEQUE_GROW(type, dq);                               \
+    dq->items[(dq->head + dq->count) & (dq->capacity - 1)] = value; \
+    ++(dq->count);                                                  \
+}
+
+/**
+ * @brief add `value` to begin of `dq`, amortized O(1)
+ * @param dq pointer to deque
+ * @param value value for prepend
+ */
+#define da_deque_push_front(type) DA_FUNC_NAME(deque_push_front, type)
+#define DA_DECLARE_DEQUE_PUSH_FRONT(type) \
+void da_deque_push_front(type)(           \
+struct DA_DEQUE_STRUCT_NAME(type)* dq,    \
+type value)
+#define DA_DEFINE_DEQUE_PUSH_FRONT(type)            \
+DA_DECLARE_DEQUE_PUSH_FRONT(type) {                 \
+    if (dq->count == dq->capacity)                  \
+        DA_IMPL_DEQUE_GROW(type, dq);               \
+    dq->head = (dq->head - 1) & (dq->capacity - 1); \
+    dq->items[dq->head] = value;                    \
+    ++(dq->count);                                  \
+}
+
+/**
+ * @brief remove last item of `dq` and return it
+ * without call destroy function
+ * @param dq pointer to non-empty deque
+ * @return removed item
+ */
+#define da_deque_pop_back(type) DA_FUNC_NAME(deque_pop_back, type)
+#define DA_DECLARE_DEQUE_POP_BACK(type) \
+type da_deque_pop_back(type)(           \
+struct DA_DEQUE_STRUCT_NAME(type)* dq)
+#define DA_DEFINE_DEQUE_POP_BACK(type)                             \
+DA_DECLARE_DEQUE_POP_BACK(type) {                                  \
+    assert(dq->count > 0 && "Empty deque");                        \
+    --(dq->count);                                                 \
+    return dq->items[(dq->head + dq->count) & (dq->capacity - 1)]; \
+}
+
+/**
+ * @brief remove first item of `dq` and return it
+ * without call destroy function
+ * @param dq pointer to non-empty deque
+ * @return removed item
+ */
+#define da_deque_pop_front(type) DA_FUNC_NAME(deque_pop_front, type)
+#define DA_DECLARE_DEQUE_POP_FRONT(type) \
+type da_deque_pop_front(type)(           \
+struct DA_DEQUE_STRUCT_NAME(type)* dq)
+#define DA_DEFINE_DEQUE_POP_FRONT(type)             \
+DA_DECLARE_DEQUE_POP_FRONT(type) {                  \
+    assert(dq->count > 0 && "Empty deque");         \
+    type value = dq->items[dq->head];               \
+    dq->head = (dq->head + 1) & (dq->capacity - 1); \
+    --(dq->count);                                  \
+    return value;                                   \
+}
+
+/**
+ * @brief destroy items, free memory for `dq` and set fields at zero
+ * @param dq pointer to deque
+ */
+#define da_deque_free(type) DA_FUNC_NAME(deque_free, type)
+#define DA_DECLARE_DEQUE_FREE(type) \
+void da_deque_free(type)(           \
+struct DA_DEQUE_STRUCT_NAME(type)* dq)
+#define DA_DEFINE_DEQUE_FREE(type)       \
+DA_DECLARE_DEQUE_FREE(type) {            \
+    if (dq->dtor != NULL)                \
+        DA_DEQUE_FOREACH(type, item, dq) \
+            dq->dtor(item);              \
+    free(dq->items);                     \
+    dq->items = NULL;                    \
+    dq->head = 0;                        \
+    dq->count = 0;                       \
+    dq->capacity = 0;                    \
+}
+
+/**
+ * Gap buffer for edits at cursor: items [0, `gap`) before cursor
+ * and items after cursor at end of buffer, free places between
+ * them move with cursor, initialized by {0}
+ */
+#define DA_GAP_BUFFER_STRUCT_NAME(type) da_gap_buffer_struct_ ## type
+#define DA_DECLARE_GAP_BUFFER(type, name) \
+typedef struct DA_GAP_BUFFER_STRUCT_NAME(type) name;
+#define DA_DEFINE_GAP_BUFFER(type, name)       \
+DA_DECLARE_GAP_BUFFER(type, name)              \
+struct DA_GAP_BUFFER_STRUCT_NAME(type) {       \
+    type*  items;                              \
+    size_t count;                              \
+    size_t capacity;                           \
+    size_t gap;     /* cursor, begin of gap */ \
+    void (*dtor)(type*);                       \
+};
+
+/* Index of end of gap, for implementation */
+#define DA_IMPL_GAP_END(gb) ((gb)->gap + (gb)->capacity - (gb)->count)
+
+/**
+ * @brief pointer to item at `index`, O(1)
+ * @param gb pointer to gap buffer
+ * @param index valid index in range [0, `gb.count`)
+ */
+#define da_gap_at(type) DA_FUNC_NAME(gap_at, type)
+#define DA_DECLARE_GAP_AT(type)                   \
+type* da_gap_at(type)(                            \
+const struct DA_GAP_BUFFER_STRUCT_NAME(type)* gb, \
+size_t index)
+#define DA_DEFINE_GAP_AT(type)                   \
+DA_DECLARE_GAP_AT(type) {                        \
+    assert(index < gb->count && "Out of range"); \
+    return &gb->items[index < gb->gap ? index    \
+        : index + gb->capacity - gb->count];     \
+}
+
+/**
+ * @brief move cursor to `pos`, shift only items between
+ * old and new cursor over gap
+ * @param gb pointer to gap buffer
+ * @param pos new cursor in range [0, `gb.count`]
+ */
+#define da_gap_move(type) DA_FUNC_NAME(gap_move, type)
+#define DA_DECLARE_GAP_MOVE(type)           \
+void da_gap_move(type)(                     \
+struct DA_GAP_BUFFER_STRUCT_NAME(type)* gb, \
+size_t pos)
+#define DA_DEFINE_GAP_MOVE(type)                                    \
+DA_DECLARE_GAP_MOVE(type) {                                         \
+    assert(pos <= gb->count && "Out of range");                     \
+    size_t end = DA_IMPL_GAP_END(gb);                               \
+    if (pos < gb->gap)                                              \
+        memmove(gb->items + end - (gb->gap - pos), gb->items + pos, \
+            (gb->gap - pos) * sizeof(type));                        \
+    else if (pos > gb->gap)                                         \
+        memmove(gb->items + gb->gap, gb->items + end,               \
+            (pos - gb->gap) * sizeof(type));                        \
+    gb->gap = pos;                                                  \
+}
+
+/**
+ * @brief insert `value` at cursor and move cursor after it,
+ * O(1) amortized, growth move only items after cursor
+ * @param gb pointer to gap buffer
+ * @param value value for insert
+ */
+#define da_gap_insert(type) DA_FUNC_NAME(gap_insert, type)
+#define DA_DECLARE_GAP_INSERT(type)         \
+void da_gap_insert(type)(                   \
+struct DA_GAP_BUFFER_STRUCT_NAME(type)* gb, \
+type value)
+#define DA_DEFINE_GAP_INSERT(type)                                  \
+DA_DECLARE_GAP_INSERT(type) {                                       \
+    if (gb->count == gb->capacity) {                                \
+        size_t after = gb->count - gb->gap;                         \
+        size_t old_cap = gb->capacity;                              \
+        DA_GROW(gb, gb->count + 1);                                 \
+        if (after > 0)                                              \
+            memmove(gb->items + gb->capacity - after,               \
+                gb->items + old_cap - after, after * sizeof(type)); \
+    }                                                               \
+    gb->items[gb->gap++] = value;                                   \
+    ++(gb->count);                                                  \
+}
+
+/**
+ * @brief destroy `n` items after cursor and join them to gap, O(n)
+ * @param gb pointer to gap buffer
+ * @param n count of items in range [0, `gb.count` - `gb.gap`]
+ */
+#define da_gap_delete(type) DA_FUNC_NAME(gap_delete, type)
+#define DA_DECLARE_GAP_DELETE(type)         \
+void da_gap_delete(type)(                   \
+struct DA_GAP_BUFFER_STRUCT_NAME(type)* gb, \
+size_t n)
+#define DA_DEFINE_GAP_DELETE(type)                      \
+DA_DECLARE_GAP_DELETE(type) {                           \
+    assert(n <= gb->count - gb->gap && "Out of range"); \
+    size_t end = DA_IMPL_GAP_END(gb);                   \
+    if (gb->dtor != NULL)                               \
+        DA_FORLOOP(i, end, end + n)                     \
+            gb->dtor(&gb->items[i]);                    \
+    gb->count -= n;                                     \
+}
+
+/**
+ * @brief get items before and after cursor as two
+ * contiguous spans without copy
+ * @param gb pointer to gap buffer
+ * @param first pointer for first span
+ * @param first_count pointer for count of items in first span
+ * @param second pointer for second span
+ * @param second_count pointer for count of items in second span
+ */
+#define da_gap_spans(type) DA_FUNC_NAME(gap_spans, type)
+#define DA_DECLARE_GAP_SPANS(type)                \
+void da_gap_spans(type)(                          \
+const struct DA_GAP_BUFFER_STRUCT_NAME(type)* gb, \
+const type** first, size_t* first_count,          \
+const type** second, size_t* second_count)
+#define DA_DEFINE_GAP_SPANS(type)              \
+DA_DECLARE_GAP_SPANS(type) {                   \
+    *first = gb->items;                        \
+    *first_count = gb->gap;                    \
+    *second = gb->items + DA_IMPL_GAP_END(gb); \
+    *second_count = gb->count - gb->gap;       \
+}
+
+/**
+ * @brief destroy items, free memory for `gb` and set fields at zero
+ * @param gb pointer to gap buffer
+ */
+#define da_gap_free(type) DA_FUNC_NAME(gap_free, type)
+#define DA_DECLARE_GAP_FREE(type) \
+void da_gap_free(type)(           \
+struct DA_GAP_BUFFER_STRUCT_NAME(type)* gb)
+#define DA_DEFINE_GAP_FREE(type)              \
+DA_DECLARE_GAP_FREE(type) {                   \
+    if (gb->dtor != NULL)                     \
+        DA_FORLOOP(i, 0, gb->count)           \
+            gb->dtor(da_gap_at(type)(gb, i)); \
+    free(gb->items);                          \
+    gb->items = NULL;                         \
+    gb->count = 0;                            \
+    gb->capacity = 0;                         \
+    gb->gap = 0;                              \
+}
+
+/* Apply `macro` to every `(type, field)` pair, up to 16 pairs,
+for implementation */
+#define DA_IMPL_CAT(a, b)  DA_IMPL_CAT_(a, b)
+#define DA_IMPL_CAT_(a, b) a ## b
+#define DA_IMPL_NARGS(...)                                 \
+DA_IMPL_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, \
+    8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define DA_IMPL_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, \
+    _11, _12, _13, _14, _15, _16, n, ...) n
+#define DA_IMPL_FOR_EACH_FIELD(macro, ...)                       \
+DA_IMPL_CAT(DA_IMPL_FOR_EACH_FIELD_, DA_IMPL_NARGS(__VA_ARGS__)) \
+    (macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_1(macro, pair) macro pair
+#define DA_IMPL_FOR_EACH_FIELD_2(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_1(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_3(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_2(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_4(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_3(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_5(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_4(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_6(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_5(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_7(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_6(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_8(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_7(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_9(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_8(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_10(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_9(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_11(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_10(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_12(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_11(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_13(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_12(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_14(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_13(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_15(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_14(macro, __VA_ARGS__)
+#define DA_IMPL_FOR_EACH_FIELD_16(macro, pair, ...) \
+macro pair DA_IMPL_FOR_EACH_FIELD_15(macro, __VA_ARGS__)
+
+/* Alignment of every column of struct of arrays */
+#define DA_SOA_ALIGN 64
+
+/* Pieces of struct of arrays per field, for implementation */
+#define DA_IMPL_SOA_MEMBER(type, field) type* field;
+#define DA_IMPL_SOA_PARAM(type, field) , type field
+#define DA_IMPL_SOA_SIZE(type, field)                \
+size += (capacity * sizeof(type) + DA_SOA_ALIGN - 1) \
+    / DA_SOA_ALIGN * DA_SOA_ALIGN;
+#define DA_IMPL_SOA_MOVE(type, field)                              \
+if (soa->count > 0)                                                \
+    memcpy(block + offset, soa->field, soa->count * sizeof(type)); \
+soa->field = (type*)(block + offset);                              \
+offset += (capacity * sizeof(type) + DA_SOA_ALIGN - 1)             \
+    / DA_SOA_ALIGN * DA_SOA_ALIGN;
+#define DA_IMPL_SOA_STORE(type, field) soa->field[soa->count] = field;
+
+/**
+ * Struct of arrays `name` with column `field` of `type` for every
+ * pair `(type, field)`, all columns in one allocation and aligned
+ * by DA_SOA_ALIGN for SIMD loops, fields must not be named `soa`,
+ * `block`, `count` or `capacity`, up to 16 fields, initialized by {0}
+ */
+#define DA_SOA_STRUCT_NAME(name) da_soa_struct_ ## name
+#define DA_IMPL_SOA_STRUCT(name, ...)                       \
+typedef struct DA_SOA_STRUCT_NAME(name) name;               \
+struct DA_SOA_STRUCT_NAME(name) {                           \
+    DA_IMPL_FOR_EACH_FIELD(DA_IMPL_SOA_MEMBER, __VA_ARGS__) \
+    void*  block;      /* start of allocation */            \
+    size_t count;                                           \
+    size_t capacity;                                        \
+};
+
+/**
+ * @brief reserve places for items in all columns by one
+ * allocation, columns copied by memcpy
+ * @param soa pointer to struct of arrays
+ * @param capacity new capacity
+ */
+#define da_soa_reserve(name) DA_FUNC_NAME(soa_reserve, name)
+/**
+ * @brief add item with `field` values in order of pairs to end of
+ * all columns, capacity grows as in da_append
+ * @param soa pointer to struct of arrays
+ */
+#define da_soa_append(name) DA_FUNC_NAME(soa_append, name)
+/**
+ * @brief free memory for `soa` and set fields at zero
+ * @param soa pointer to struct of arrays
+ */
+#define da_soa_free(name) DA_FUNC_NAME(soa_free, name)
+
+/* Declaration of struct of arrays functions, for implementation */
+#define DA_IMPL_SOA_RESERVE_HEAD(name)                          \
+void da_soa_reserve(name)(struct DA_SOA_STRUCT_NAME(name)* soa, \
+size_t capacity)
+#define DA_IMPL_SOA_APPEND_HEAD(name, ...)                    \
+void da_soa_append(name)(struct DA_SOA_STRUCT_NAME(name)* soa \
+DA_IMPL_FOR_EACH_FIELD(DA_IMPL_SOA_PARAM, __VA_ARGS__))
+#define DA_IMPL_SOA_FREE_HEAD(name) \
+void da_soa_free(name)(struct DA_SOA_STRUCT_NAME(name)* soa)
+
+/* declare struct of arrays with functions, for headers */
+#define DA_DECLARE_SOA(name, ...)           \
+DA_IMPL_SOA_STRUCT(name, __VA_ARGS__)       \
+DA_IMPL_SOA_RESERVE_HEAD(name);             \
+DA_IMPL_SOA_APPEND_HEAD(name, __VA_ARGS__); \
+DA_IMPL_SOA_FREE_HEAD(name);
+
+/* define struct of arrays with functions */
+#define DA_DEFINE_SOA(name, ...)      \
+DA_IMPL_SOA_STRUCT(name, __VA_ARGS__) \
+DA_DEFINE_SOA_FUNCTIONS(name, __VA_ARGS__)
+
+/* define functions of struct of arrays declared by DA_DECLARE_SOA */
+#define DA_DEFINE_SOA_FUNCTIONS(name, ...)                 \
+DA_IMPL_SOA_RESERVE_HEAD(name) {                           \
+    if (capacity <= soa->capacity) return;                 \
+    size_t size = 0;                                       \
+    DA_IMPL_FOR_EACH_FIELD(DA_IMPL_SOA_SIZE, __VA_ARGS__)  \
+    /* aligned by hand, aligned_alloc is C11 */            \
+    char* base = malloc(size + DA_SOA_ALIGN - 1);          \
+    assert(base != NULL && "Not memory");                  \
+    char* block = base + (DA_SOA_ALIGN                     \
+        - (uintptr_t)base % DA_SOA_ALIGN) % DA_SOA_ALIGN;  \
+    size_t offset = 0;                                     \
+    DA_IMPL_FOR_EACH_FIELD(DA_IMPL_SOA_MOVE, __VA_ARGS__)  \
+    free(soa->block);                                      \
+    soa->block = base;                                     \
+    soa->capacity = capacity;                              \
+}                                                          \
+DA_IMPL_SOA_APPEND_HEAD(name, __VA_ARGS__) {               \
+    if (soa->count >= soa->capacity)                       \
+        da_soa_reserve(name)(soa, soa->capacity == 0       \
+            ? DA_DEFAULT_INIT_CAP                          \
+            : soa->capacity + (soa->capacity + 1) / 2);    \
+    DA_IMPL_FOR_EACH_FIELD(DA_IMPL_SOA_STORE, __VA_ARGS__) \
+    ++(soa->count);                                        \
+}                                                          \
+DA_IMPL_SOA_FREE_HEAD(name) {                              \
+    free(soa->block);                                      \
+    memset(soa, 0, sizeof(*soa));                          \
+}
+
+/* Count of set bits in `x`, for implementation */
+static inline size_t da_impl_popcount64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (size_t)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+/* Index of lowest set bit of non-zero `x`, for implementation */
+static inline size_t da_impl_ctz64(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_ctzll(x);
+#else
+    size_t index = 0;
+    while ((x & 1) == 0) { x >>= 1; ++index; }
+    return index;
+#endif
+}
+
+#ifdef DA_X86_SIMD
+/* Popcount of words by nibble lookup^6, for implementation */
+static inline __attribute__((target("avx2")))
+size_t da_impl_popcount_avx2(const uint64_t* words, size_t n) {
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i bits = _mm256_add_epi8(
+            _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low)),
+            _mm256_shuffle_epi8(lookup,
+                _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+        acc = _mm256_add_epi64(acc,
+            _mm256_sad_epu8(bits, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    size_t total = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    for (; i < n; ++i) total += da_impl_popcount64(words[i]);
+    return total;
+}
+
+/* Index of first non-zero word or `n`, for implementation */
+static inline __attribute__((target("avx2")))
+size_t da_impl_nonzero_avx2(const uint64_t* words, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+        if (!_mm256_testz_si256(v, v)) break;
+    }
+    while (i < n && words[i] == 0) ++i;
+    return i;
+}
+#endif // DA_X86_SIMD
+
+/* Count of set bits in `n` words, for implementation */
+static inline size_t da_impl_popcount(const uint64_t* words, size_t n) {
+#ifdef DA_X86_SIMD
+    if (da_impl_simd_level() >= DA_IMPL_SIMD_AVX2)
+        return da_impl_popcount_avx2(words, n);
+#endif
+    size_t total = 0;
+    DA_FORLOOP(i, 0, n) total += da_impl_popcount64(words[i]);
+    return total;
+}
+
+/* Index of first non-zero word of `n` words or `n`, for implementation */
+static inline size_t da_impl_nonzero(const uint64_t* words, size_t n) {
+#ifdef DA_X86_SIMD
+    if (da_impl_simd_level() >= DA_IMPL_SIMD_AVX2)
+        return da_impl_nonzero_avx2(words, n);
+#endif
+    size_t i = 0;
+    while (i < n && words[i] == 0) ++i;
+    return i;
+}
+
+/* Count of words for `bits` bits, for implementation */
+#define DA_IMPL_BITS_WORDS(bits) (((bits) + 63) / 64)
+
+/**
+ * Bit array `name` with 64 flags per word, bits after `count`
+ * in last word are always zero, initialized by {0}
+ */
+#define DA_BITARRAY_STRUCT_NAME(name) da_bitarray_struct_ ## name
+#define DA_IMPL_BITARRAY_STRUCT(name)              \
+typedef struct DA_BITARRAY_STRUCT_NAME(name) name; \
+struct DA_BITARRAY_STRUCT_NAME(name) {             \
+    uint64_t* items;                               \
+    size_t count;       /* bits */                 \
+    size_t capacity;    /* words */                \
+};
+
+/**
+ * @brief add `bit` (zero or not) to end of `ba`
+ * @param ba pointer to bit array
+ * @param bit value for append
+ */
+#define da_bits_append(name) DA_FUNC_NAME(bits_append, name)
+/**
+ * @brief add flags from `bytes` (zero or not) to end of `ba`
+ * @param ba pointer to bit array
+ * @param bytes pointer to array of flags
+ * @param count count of flags in `bytes`
+ */
+#define da_bits_append_many(name) DA_FUNC_NAME(bits_append_many, name)
+/**
+ * @brief get bit at `index`
+ * @param ba pointer to bit array
+ * @param index valid index in range [0, `ba.count`)
+ * @return 1 if bit set, else 0
+ */
+#define da_bits_get(name) DA_FUNC_NAME(bits_get, name)
+/**
+ * @brief set bit at `index` to `bit` (zero or not)
+ * @param ba pointer to bit array
+ * @param index valid index in range [0, `ba.count`)
+ * @param bit new value
+ */
+#define da_bits_set(name) DA_FUNC_NAME(bits_set, name)
+/**
+ * @brief count set bits (SIMD)
+ * @param ba pointer to bit array
+ */
+#define da_bits_popcount(name) DA_FUNC_NAME(bits_popcount, name)
+/**
+ * @brief find index of first set bit not less than `from`
+ * or `ba.count` if not exist (SIMD)
+ * @param ba pointer to bit array
+ * @param from index for begin of search
+ */
+#define da_bits_find_first_set(name) DA_FUNC_NAME(bits_find_first_set, name)
+/**
+ * @brief `dst` = `dst` & `src` by words, arrays with same count
+ * @param dst pointer to destination bit array
+ * @param src pointer to source bit array
+ */
+#define da_bits_and(name) DA_FUNC_NAME(bits_and, name)
+/* `dst` = `dst` | `src`, as da_bits_and */
+#define da_bits_or(name)  DA_FUNC_NAME(bits_or, name)
+/* `dst` = `dst` ^ `src`, as da_bits_and */
+#define da_bits_xor(name) DA_FUNC_NAME(bits_xor, name)
+/**
+ * @brief free memory for `ba` and set fields at zero
+ * @param ba pointer to bit array
+ */
+#define da_bits_free(name) DA_FUNC_NAME(bits_free, name)
+
+/* Declaration of bit array functions, for implementation */
+#define DA_IMPL_BITS_APPEND_HEAD(name)                              \
+void da_bits_append(name)(struct DA_BITARRAY_STRUCT_NAME(name)* ba, \
+int bit)
+#define DA_IMPL_BITS_APPEND_MANY_HEAD(name) \
+void da_bits_append_many(name)(             \
+struct DA_BITARRAY_STRUCT_NAME(name)* ba,   \
+const uint8_t* bytes, size_t count)
+#define DA_IMPL_BITS_GET_HEAD(name)                                   \
+int da_bits_get(name)(const struct DA_BITARRAY_STRUCT_NAME(name)* ba, \
+size_t index)
+#define DA_IMPL_BITS_SET_HEAD(name)                              \
+void da_bits_set(name)(struct DA_BITARRAY_STRUCT_NAME(name)* ba, \
+size_t index, int bit)
+#define DA_IMPL_BITS_POPCOUNT_HEAD(name) \
+size_t da_bits_popcount(name)(           \
+const struct DA_BITARRAY_STRUCT_NAME(name)* ba)
+#define DA_IMPL_BITS_FIND_FIRST_SET_HEAD(name) \
+size_t da_bits_find_first_set(name)(           \
+const struct DA_BITARRAY_STRUCT_NAME(name)* ba, size_t from)
+#define DA_IMPL_BITS_BULK_HEAD(name, op)                           \
+void da_bits_##op(name)(struct DA_BITARRAY_STRUCT_NAME(name)* dst, \
+const struct DA_BITARRAY_STRUCT_NAME(name)* src)
+#define DA_IMPL_BITS_FREE_HEAD(name) \
+void da_bits_free(name)(struct DA_BITARRAY_STRUCT_NAME(name)* ba)
+
+/* Body of bulk operation by words, vectorized by compiler,
+for implementation */
+#define DA_IMPL_BITS_BULK(name, op, sign)                  \
+DA_IMPL_BITS_BULK_HEAD(name, op) {                         \
+    assert(dst->count == src->count && "Different count"); \
+    uint64_t* out = dst->items;                            \
+    const uint64_t* in = src->items;                       \
+    DA_FORLOOP(i, 0, DA_IMPL_BITS_WORDS(dst->count))       \
+        out[i] sign in[i];                                 \
+}
+
+/* declare bit array with functions, for headers */
+#define DA_DECLARE_BITARRAY(name)       \
+DA_IMPL_BITARRAY_STRUCT(name)           \
+DA_IMPL_BITS_APPEND_HEAD(name);         \
+DA_IMPL_BITS_APPEND_MANY_HEAD(name);    \
+DA_IMPL_BITS_GET_HEAD(name);            \
+DA_IMPL_BITS_SET_HEAD(name);            \
+DA_IMPL_BITS_POPCOUNT_HEAD(name);       \
+DA_IMPL_BITS_FIND_FIRST_SET_HEAD(name); \
+DA_IMPL_BITS_BULK_HEAD(name, and);      \
+DA_IMPL_BITS_BULK_HEAD(name, or);       \
+DA_IMPL_BITS_BULK_HEAD(name, xor);      \
+DA_IMPL_BITS_FREE_HEAD(name);
+
+/* define bit array with functions */
+#define DA_DEFINE_BITARRAY(name) \
+DA_IMPL_BITARRAY_STRUCT(name)    \
+DA_DEFINE_BITARRAY_FUNCTIONS(name)
+
+/* define functions of bit array declared by DA_DECLARE_BITARRAY */
+#define DA_DEFINE_BITARRAY_FUNCTIONS(name)                               \
+DA_IMPL_BITS_APPEND_HEAD(name) {                                         \
+    if (ba->count % 64 == 0) {                                           \
+        DA_GROW(ba, ba->count / 64 + 1);                                 \
+        ba->items[ba->count / 64] = 0;                                   \
+    }                                                                    \
+    ba->items[ba->count / 64] |= (uint64_t)(bit != 0) << ba->count % 64; \
+    ++(ba->count);                                                       \
+}                                                                        \
+DA_IMPL_BITS_APPEND_MANY_HEAD(name) {                                    \
+    if (count == 0) return;                                              \
+    DA_GROW(ba, DA_IMPL_BITS_WORDS(ba->count + count));                  \
+    size_t i = 0;                                                        \
+    while (i < count && ba->count % 64 != 0)                             \
+        da_bits_append(name)(ba, bytes[i++]);                            \
+    for (; i + 64 <= count; i += 64) {                                   \
+        uint64_t word = 0;                                               \
+        for (size_t j = 0; j < 64; ++j)                                  \
+            word |= (uint64_t)(bytes[i + j] != 0) << j;                  \
+        ba->items[ba->count / 64] = word;                                \
+        ba->count += 64;                                                 \
+    }                                                                    \
+    while (i < count)                                                    \
+        da_bits_append(name)(ba, bytes[i++]);                            \
+}                                                                        \
+DA_IMPL_BITS_GET_HEAD(name) {                                            \
+    assert(index < ba->count && "Out of range");                         \
+    return (int)(ba->items[index / 64] >> index % 64 & 1);               \
+}                                                                        \
+DA_IMPL_BITS_SET_HEAD(name) {                                            \
+    assert(index < ba->count && "Out of range");                         \
+    uint64_t mask = (uint64_t)1 << index % 64;                           \
+    if (bit) ba->items[index / 64] |= mask;                              \
+    else     ba->items[index / 64] &= ~mask;                             \
+}                                                                        \
+DA_IMPL_BITS_POPCOUNT_HEAD(name) {                                       \
+    return da_impl_popcount(ba->items, DA_IMPL_BITS_WORDS(ba->count));   \
+}                                                                        \
+DA_IMPL_BITS_FIND_FIRST_SET_HEAD(name) {                                 \
+    if (from >= ba->count) return ba->count;                             \
+    size_t words = DA_IMPL_BITS_WORDS(ba->count);                        \
+    size_t w = from / 64;                                                \
+    uint64_t word = ba->items[w] & (~(uint64_t)0 << from % 64);          \
+    if (word == 0) {                                                     \
+        w += 1 + da_impl_nonzero(ba->items + w + 1, words - w - 1);      \
+        if (w == words) return ba->count;                                \
+        word = ba->items[w];                                             \
+    }                                                                    \
+    return w * 64 + da_impl_ctz64(word);                                 \
+}                                                                        \
+DA_IMPL_BITS_BULK(name, and, &=)                                         \
+DA_IMPL_BITS_BULK(name, or,  |=)                                         \
+DA_IMPL_BITS_BULK(name, xor, ^=)                                         \
+DA_IMPL_BITS_FREE_HEAD(name) {                                           \
+    free(ba->items);                                                     \
+    ba->items = NULL;                                                    \
+    ba->count = 0;                                                       \
+    ba->capacity = 0;                                                    \
+}
+
+/* Handle of value in slot map, stale after erase by generation */
+typedef struct da_handle {
+    uint32_t index;
+    uint32_t generation;
+} da_handle;
+
+/* Slot of slot map: dense index if used or next free slot + 1,
+for implementation */
+struct da_impl_slot {
+    uint32_t index;
+    uint32_t generation;
+};
+
+/**
+ * Slot map: values packed in `items` as in 'da', so DA_FOREACH
+ * iterate them, handles point to slots with dense index and
+ * generation, `owners` map dense index back to slot,
+ * initialized by {0}
+ */
+#define DA_SLOTMAP_STRUCT_NAME(type) da_slotmap_struct_ ## type
+#define DA_DECLARE_SLOTMAP(type, name) \
+typedef struct DA_SLOTMAP_STRUCT_NAME(type) name;
+#define DA_DEFINE_SLOTMAP(type, name)               \
+DA_DECLARE_SLOTMAP(type, name)                      \
+struct DA_SLOTMAP_STRUCT_NAME(type) {               \
+    type*  items;                                   \
+    size_t count;                                   \
+    size_t capacity;                                \
+    void (*dtor)(type*);                            \
+    struct {                                        \
+        uint32_t* items;                            \
+        size_t count;                               \
+        size_t capacity;                            \
+    } owners;                                       \
+    struct {                                        \
+        struct da_impl_slot* items;                 \
+        size_t count;                               \
+        size_t capacity;                            \
+    } slots;                                        \
+    uint32_t free_slot;    /* free slot + 1 or 0 */ \
+};
+
+/**
+ * @brief add `value` to end of values, O(1) amortized
+ * @param sm pointer to slot map
+ * @param value value for insert
+ * @return handle of inserted value
+ */
+#define da_slotmap_insert(type) DA_FUNC_NAME(slotmap_insert, type)
+#define DA_DECLARE_SLOTMAP_INSERT(type)  \
+da_handle da_slotmap_insert(type)(       \
+struct DA_SLOTMAP_STRUCT_NAME(type)* sm, \
+type value)
+#define DA_DEFINE_SLOTMAP_INSERT(type)                            \
+DA_DECLARE_SLOTMAP_INSERT(type) {                                 \
+    uint32_t slot;                                                \
+    if (sm->free_slot == 0) {                                     \
+        assert(sm->slots.count < UINT32_MAX && "Overflow");       \
+        DA_GROW(&sm->slots, sm->slots.count + 1);                 \
+        slot = (uint32_t)sm->slots.count++;                       \
+        sm->slots.items[slot].generation = 0;                     \
+    } else {                                                      \
+        slot = sm->free_slot - 1;                                 \
+        sm->free_slot = sm->slots.items[slot].index;              \
+    }                                                             \
+    DA_GROW(sm, sm->count + 1);                                   \
+    DA_GROW(&sm->owners, sm->count + 1);                          \
+    sm->items[sm->count] = value;                                 \
+    sm->owners.items[sm->count] = slot;                           \
+    sm->slots.items[slot].index = (uint32_t)sm->count++;          \
+    return (da_handle){ slot, sm->slots.items[slot].generation }; \
+}
+
+/**
+ * @brief pointer to value by `handle`, O(1)
+ * @param sm pointer to slot map
+ * @param handle handle from da_slotmap_insert
+ * @return pointer to value or NULL if handle stale
+ */
+#define da_slotmap_get(type) DA_FUNC_NAME(slotmap_get, type)
+#define DA_DECLARE_SLOTMAP_GET(type)           \
+type* da_slotmap_get(type)(                    \
+const struct DA_SLOTMAP_STRUCT_NAME(type)* sm, \
+da_handle handle)
+#define DA_DEFINE_SLOTMAP_GET(type)                           \
+DA_DECLARE_SLOTMAP_GET(type) {                                \
+    if (handle.index >= sm->slots.count) return NULL;         \
+    struct da_impl_slot slot = sm->slots.items[handle.index]; \
+    if (slot.generation != handle.generation) return NULL;    \
+    return &sm->items[slot.index];                            \
+}
+
+/**
+ * @brief destroy value by `handle` and move last value to its
+ * place, O(1), handles of other values stay valid
+ * @param sm pointer to slot map
+ * @param handle handle from da_slotmap_insert
+ * @return 1 if erased, 0 if handle stale
+ */
+#define da_slotmap_erase(type) DA_FUNC_NAME(slotmap_erase, type)
+#define DA_DECLARE_SLOTMAP_ERASE(type)   \
+int da_slotmap_erase(type)(              \
+struct DA_SLOTMAP_STRUCT_NAME(type)* sm, \
+da_handle handle)
+#define DA_DEFINE_SLOTMAP_ERASE(type)                           \
+DA_DECLARE_SLOTMAP_ERASE(type) {                                \
+    if (handle.index >= sm->slots.count) return 0;              \
+    struct da_impl_slot* slot = &sm->slots.items[handle.index]; \
+    if (slot->generation != handle.generation) return 0;        \
+    uint32_t dense = slot->index;                               \
+    if (sm->dtor != NULL)                                       \
+        sm->dtor(&sm->items[dense]);                            \
+    size_t last = --(sm->count);                                \
+    sm->items[dense] = sm->items[last];                         \
+    sm->owners.items[dense] = sm->owners.items[last];           \
+    sm->slots.items[sm->owners.items[dense]].index = dense;     \
+    ++(slot->generation);                                       \
+    slot->index = sm->free_slot;                                \
+    sm->free_slot = handle.index + 1;                           \
+    return 1;                                                   \
+}
+
+/**
+ * @brief destroy values, free memory for `sm` and set fields
+ * at zero except destroy function
+ * @param sm pointer to slot map
+ */
+#define da_slotmap_free(type) DA_FUNC_NAME(slotmap_free, type)
+#define DA_DECLARE_SLOTMAP_FREE(type) \
+void da_slotmap_free(type)(           \
+struct DA_SLOTMAP_STRUCT_NAME(type)* sm)
+#define DA_DEFINE_SLOTMAP_FREE(type) \
+DA_DECLARE_SLOTMAP_FREE(type) {      \
+    if (sm->dtor != NULL)            \
+        DA_FOREACH(type, item, sm)   \
+            sm->dtor(item);          \
+    free(sm->items);                 \
+    free(sm->owners.items);          \
+    free(sm->slots.items);           \
+    void (*dtor)(type*) = sm->dtor;  \
+    memset(sm, 0, sizeof(*sm));      \
+    sm->dtor = dtor;                 \
+}
+
+/**
+ * Sparse set of unsigned integer keys: keys packed in `items`
+ * as in 'da', so DA_FOREACH iterate them, `pages` of sparse
+ * array map key to dense index and allocated on first key
+ * in page, initialized by {0}
+ */
+#define DA_SPARSE_SET_STRUCT_NAME(type) da_sparse_set_struct_ ## type
+#define DA_DECLARE_SPARSE_SET(type, name) \
+typedef struct DA_SPARSE_SET_STRUCT_NAME(type) name;
+#define DA_DEFINE_SPARSE_SET(type, name) \
+DA_DECLARE_SPARSE_SET(type, name)        \
+struct DA_SPARSE_SET_STRUCT_NAME(type) { \
+    type*  items;                        \
+    size_t count;                        \
+    size_t capacity;                     \
+    struct {                             \
+        size_t** items;                  \
+        size_t count;                    \
+        size_t capacity;                 \
+    } pages;                             \
+};
+
+/* Dense index slot of `key` or NULL if page absent, for implementation */
+#define DA_IMPL_SPARSE_SLOT(ss, key)                                  \
+((size_t)(key) / DA_SPARSE_PAGE_SIZE < (ss)->pages.count              \
+    && (ss)->pages.items[(size_t)(key) / DA_SPARSE_PAGE_SIZE] != NULL \
+    ? &(ss)->pages.items[(size_t)(key) / DA_SPARSE_PAGE_SIZE]         \
+        [(size_t)(key) % DA_SPARSE_PAGE_SIZE]                         \
+    : NULL)
+
+/**
+ * @brief check `ss` contains `key`, O(1)
+ * @param ss pointer to sparse set
+ * @param key key for search
+ * @return 1 if contains, else 0
+ */
+#define da_sparse_contains(type) DA_FUNC_NAME(sparse_contains, type)
+#define DA_DECLARE_SPARSE_CONTAINS(type)          \
+int da_sparse_contains(type)(                     \
+const struct DA_SPARSE_SET_STRUCT_NAME(type)* ss, \
+type key)
+#define DA_DEFINE_SPARSE_CONTAINS(type)                \
+DA_DECLARE_SPARSE_CONTAINS(type) {                     \
+    const size_t* slot = DA_IMPL_SPARSE_SLOT(ss, key); \
+    return slot != NULL && *slot < ss->count           \
+        && ss->items[*slot] == key;                    \
+}
+
+/**
+ * @brief add `key` to end of dense keys if absent, O(1) amortized,
+ * allocate page of sparse array for `key` if need
+ * @param ss pointer to sparse set
+ * @param key key for add
+ * @return 1 if added, 0 if already contains
+ */
+#define da_sparse_add(type) DA_FUNC_NAME(sparse_add, type)
+#define DA_DECLARE_SPARSE_ADD(type)         \
+int da_sparse_add(type)(                    \
+struct DA_SPARSE_SET_STRUCT_NAME(type)* ss, \
+type key)
+#define DA_DEFINE_SPARSE_ADD(type)                              \
+DA_DECLARE_SPARSE_ADD(type) {                                   \
+    size_t page = (size_t)key / DA_SPARSE_PAGE_SIZE;            \
+    if (page >= ss->pages.count) {                              \
+        DA_GROW(&ss->pages, page + 1);                          \
+        memset(ss->pages.items + ss->pages.count, 0,            \
+            (page + 1 - ss->pages.count) * sizeof(size_t*));    \
+        ss->pages.count = page + 1;                             \
+    }                                                           \
+    if (ss->pages.items[page] == NULL) {                        \
+        ss->pages.items[page] = calloc(DA_SPARSE_PAGE_SIZE,     \
+            sizeof(size_t));                                    \
+        assert(ss->pages.items[page] != NULL && "Not memory");  \
+    }                                                           \
+    size_t* slot = &ss->pages.items[page]                       \
+        [(size_t)key % DA_SPARSE_PAGE_SIZE];                    \
+    if (*slot < ss->count && ss->items[*slot] == key) return 0; \
+    DA_GROW(ss, ss->count + 1);                                 \
+    *slot = ss->count;                                          \
+    ss->items[ss->count++] = key;                               \
+    return 1;                                                   \
+}
+
+/**
+ * @brief remove `key` and move last dense key to its place, O(1)
+ * @param ss pointer to sparse set
+ * @param key key for remove
+ * @return 1 if removed, 0 if not contains
+ */
+#define da_sparse_remove(type) DA_FUNC_NAME(sparse_remove, type)
+#define DA_DECLARE_SPARSE_REMOVE(type)      \
+int da_sparse_remove(type)(                 \
+struct DA_SPARSE_SET_STRUCT_NAME(type)* ss, \
+type key)
+#define DA_DEFINE_SPARSE_REMOVE(type)            \
+DA_DECLARE_SPARSE_REMOVE(type) {                 \
+    size_t* slot = DA_IMPL_SPARSE_SLOT(ss, key); \
+    if (slot == NULL || *slot >= ss->count       \
+        || ss->items[*slot] != key) return 0;    \
+    type last = ss->items[--(ss->count)];        \
+    ss->items[*slot] = last;                     \
+    *DA_IMPL_SPARSE_SLOT(ss, last) = *slot;      \
+    return 1;                                    \
+}
+
+/**
+ * @brief free dense keys and all pages, set fields at zero
+ * @param ss pointer to sparse set
+ */
+#define da_sparse_free(type) DA_FUNC_NAME(sparse_free, type)
+#define DA_DECLARE_SPARSE_FREE(type) \
+void da_sparse_free(type)(           \
+struct DA_SPARSE_SET_STRUCT_NAME(type)* ss)
+#define DA_DEFINE_SPARSE_FREE(type)   \
+DA_DECLARE_SPARSE_FREE(type) {        \
+    DA_FORLOOP(i, 0, ss->pages.count) \
+        free(ss->pages.items[i]);     \
+    free(ss->pages.items);            \
+    free(ss->items);                  \
+    memset(ss, 0, sizeof(*ss));       \
+}
+
+/* Maximal capacity of hive block, skipfield fit in uint16_t */
+#define DA_HIVE_MAX_BLOCK 65535
+/* End of list of free runs in hive block, for implementation */
+#define DA_IMPL_HIVE_NONE UINT16_MAX
+
+/**
+ * Hive: values in blocks which never move, block capacity grows
+ * as in da_append, erased slots form runs, first and last slot of
+ * run keep its length in skipfield^7, so iteration jump over run,
+ * first slot of run is node of intrusive list of free runs in
+ * block, blocks sorted by address for find block of value
+ */
+#define DA_HIVE_STRUCT_NAME(type) da_hive_struct_ ## type
+#define DA_DECLARE_HIVE(type, name) \
+typedef struct DA_HIVE_STRUCT_NAME(type) name;
+#define DA_DEFINE_HIVE(type, name)                             \
+DA_DECLARE_HIVE(type, name)                                    \
+union DA_FUNC_NAME(hive_cell, type) {                          \
+    type value;                                                \
+    struct { uint16_t prev, next; } run;                       \
+};                                                             \
+struct DA_FUNC_NAME(hive_block, type) {                        \
+    union DA_FUNC_NAME(hive_cell, type)* cells;                \
+    uint16_t* skip;     /* capacity + 1, zero for used slot */ \
+    size_t capacity;                                           \
+    size_t size;        /* slots used at least once */         \
+    uint16_t free_run;  /* first slot of free run */           \
+    int has_free;       /* block in stack `free_blocks` */     \
+    struct DA_FUNC_NAME(hive_block, type)* next_free;          \
+};                                                             \
+struct DA_HIVE_STRUCT_NAME(type) {                             \
+    struct {                                                   \
+        struct DA_FUNC_NAME(hive_block, type)** items;         \
+        size_t count;                                          \
+        size_t capacity;                                       \
+    } blocks;                                                  \
+    struct DA_FUNC_NAME(hive_block, type)* tail;               \
+    struct DA_FUNC_NAME(hive_block, type)* free_blocks;        \
+    size_t count;                                              \
+    void (*dtor)(type*);                                       \
+};
+
+/* Index of first used slot at or after `index`, branch keep next
+index independent of load of skipfield, for implementation */
+#define DA_IMPL_HIVE_FROM(block, index) \
+((block)->skip[index] == 0 ? (index) : (index) + (block)->skip[index])
+
+/* For loop macros over hive by cached block, `break` leave only block */
+#define DA_HIVE_FOREACH(type, item_ptr_name, hv)                      \
+for (size_t item_ptr_name##_b = 0;                                    \
+    item_ptr_name##_b < (hv)->blocks.count; ++item_ptr_name##_b)      \
+for (struct DA_FUNC_NAME(hive_block, type)* item_ptr_name##_block =   \
+        (hv)->blocks.items[item_ptr_name##_b];                        \
+    item_ptr_name##_block != NULL; item_ptr_name##_block = NULL)      \
+for (type* item_ptr_name = (type*)(item_ptr_name##_block->cells       \
+        + DA_IMPL_HIVE_FROM(item_ptr_name##_block, 0));               \
+    (union DA_FUNC_NAME(hive_cell, type)*)item_ptr_name               \
+        < item_ptr_name##_block->cells + item_ptr_name##_block->size; \
+    item_ptr_name = (type*)(item_ptr_name##_block->cells              \
+        + DA_IMPL_HIVE_FROM(item_ptr_name##_block,                    \
+            (size_t)((union DA_FUNC_NAME(hive_cell, type)*)           \
+                item_ptr_name - item_ptr_name##_block->cells) + 1)))
+
+/* Replace free run `from` by `to` in list of block, for implementation */
+#define DA_IMPL_HIVE_MOVE_RUN(block, from, to)                       \
+do {                                                                 \
+    (block)->cells[to].run = (block)->cells[from].run;               \
+    if ((block)->cells[to].run.prev != DA_IMPL_HIVE_NONE)            \
+        (block)->cells[(block)->cells[to].run.prev].run.next = (to); \
+    else                                                             \
+        (block)->free_run = (to);                                    \
+    if ((block)->cells[to].run.next != DA_IMPL_HIVE_NONE)            \
+        (block)->cells[(block)->cells[to].run.next].run.prev = (to); \
+} while (0)
+
+/* Unlink free run `at` from list of block, for implementation */
+#define DA_IMPL_HIVE_UNLINK_RUN(block, at)                               \
+do {                                                                     \
+    uint16_t prev = (block)->cells[at].run.prev;                         \
+    uint16_t next = (block)->cells[at].run.next;                         \
+    if (prev != DA_IMPL_HIVE_NONE) (block)->cells[prev].run.next = next; \
+    else                           (block)->free_run = next;             \
+    if (next != DA_IMPL_HIVE_NONE) (block)->cells[next].run.prev = prev; \
+} while (0)
+
+/**
+ * @brief add `value` to first free run or to end of last block,
+ * allocate new block if need, O(1) amortized
+ * @param hv pointer to hive
+ * @param value value for insert
+ * @return pointer to inserted value, valid until its erase
+ */
+#define da_hive_insert(type) DA_FUNC_NAME(hive_insert, type)
+#define DA_DECLARE_HIVE_INSERT(type)  \
+type* da_hive_insert(type)(           \
+struct DA_HIVE_STRUCT_NAME(type)* hv, \
+type value)
+#define DA_DEFINE_HIVE_INSERT(type)                                     \
+DA_DECLARE_HIVE_INSERT(type) {                                          \
+    struct DA_FUNC_NAME(hive_block, type)* block;                       \
+    size_t index;                                                       \
+    while (hv->free_blocks != NULL                                      \
+        && hv->free_blocks->free_run == DA_IMPL_HIVE_NONE) {            \
+        hv->free_blocks->has_free = 0;                                  \
+        hv->free_blocks = hv->free_blocks->next_free;                   \
+    }                                                                   \
+    if (hv->free_blocks != NULL) {                                      \
+        block = hv->free_blocks;                                        \
+        index = block->free_run;                                        \
+        size_t length = block->skip[index];                             \
+        if (length == 1) {                                              \
+            DA_IMPL_HIVE_UNLINK_RUN(block, index);                      \
+        } else {                                                        \
+            DA_IMPL_HIVE_MOVE_RUN(block, index, index + 1);             \
+            block->skip[index + 1] = (uint16_t)(length - 1);            \
+            block->skip[index + length - 1] = (uint16_t)(length - 1);   \
+        }                                                               \
+        block->skip[index] = 0;                                         \
+    } else {                                                            \
+        block = hv->tail;                                               \
+        if (block == NULL || block->size == block->capacity) {          \
+            block = malloc(sizeof(*block));                             \
+            assert(block != NULL && "Not memory");                      \
+            block->capacity = hv->tail == NULL ? DA_DEFAULT_INIT_CAP    \
+                : hv->tail->capacity + (hv->tail->capacity + 1) / 2;    \
+            if (block->capacity > DA_HIVE_MAX_BLOCK)                    \
+                block->capacity = DA_HIVE_MAX_BLOCK;                    \
+            block->cells = malloc(block->capacity                       \
+                * sizeof(*block->cells));                               \
+            block->skip = calloc(block->capacity + 1,                   \
+                sizeof(*block->skip));                                  \
+            assert(block->cells != NULL && block->skip != NULL          \
+                && "Not memory");                                       \
+            block->size = 0;                                            \
+            block->free_run = DA_IMPL_HIVE_NONE;                        \
+            block->has_free = 0;                                        \
+            block->next_free = NULL;                                    \
+            DA_GROW(&hv->blocks, hv->blocks.count + 1);                 \
+            size_t at = hv->blocks.count++;                             \
+            while (at > 0 && (uintptr_t)hv->blocks.items[at - 1]->cells \
+                > (uintptr_t)block->cells) {                            \
+                hv->blocks.items[at] = hv->blocks.items[at - 1];        \
+                --at;                                                   \
+            }                                                           \
+            hv->blocks.items[at] = block;                               \
+            hv->tail = block;                                           \
+        }                                                               \
+        index = block->size++;                                          \
+    }                                                                   \
+    block->cells[index].value = value;                                  \
+    ++(hv->count);                                                      \
+    return &block->cells[index].value;                                  \
+}
+
+/**
+ * @brief destroy value by pointer and join its slot to free runs,
+ * O(1) for slot and O(log blocks) for find block, other values
+ * never move
+ * @param hv pointer to hive
+ * @param item pointer to value from hive
+ */
+#define da_hive_erase(type) DA_FUNC_NAME(hive_erase, type)
+#define DA_DECLARE_HIVE_ERASE(type)   \
+void da_hive_erase(type)(             \
+struct DA_HIVE_STRUCT_NAME(type)* hv, \
+type* item)
+#define DA_DEFINE_HIVE_ERASE(type)                                    \
+DA_DECLARE_HIVE_ERASE(type) {                                         \
+    union DA_FUNC_NAME(hive_cell, type)* cell = (void*)item;          \
+    size_t first = 0, last = hv->blocks.count;                        \
+    while (last - first > 1) {                                        \
+        size_t middle = first + (last - first) / 2;                   \
+        if ((uintptr_t)hv->blocks.items[middle]->cells                \
+            <= (uintptr_t)cell) first = middle;                       \
+        else last = middle;                                           \
+    }                                                                 \
+    assert(first < hv->blocks.count && "Not from hive");              \
+    struct DA_FUNC_NAME(hive_block, type)* block =                    \
+        hv->blocks.items[first];                                      \
+    size_t index = (size_t)(cell - block->cells);                     \
+    assert(index < block->size && block->skip[index] == 0             \
+        && "Not from hive");                                          \
+    if (hv->dtor != NULL)                                             \
+        hv->dtor(item);                                               \
+    size_t left = index > 0 ? block->skip[index - 1] : 0;             \
+    size_t right = block->skip[index + 1];                            \
+    size_t length = left + 1 + right;                                 \
+    if (right > 0) {                                                  \
+        if (left > 0) DA_IMPL_HIVE_UNLINK_RUN(block, index + 1);      \
+        else          DA_IMPL_HIVE_MOVE_RUN(block, index + 1, index); \
+    } else if (left == 0) {                                           \
+        block->cells[index].run.prev = DA_IMPL_HIVE_NONE;             \
+        block->cells[index].run.next = block->free_run;               \
+        if (block->free_run != DA_IMPL_HIVE_NONE)                     \
+            block->cells[block->free_run].run.prev = (uint16_t)index; \
+        block->free_run = (uint16_t)index;                            \
+    }                                                                 \
+    block->skip[index - left] = (uint16_t)length;                     \
+    block->skip[index + right] = (uint16_t)length;                    \
+    if (!block->has_free) {                                           \
+        block->has_free = 1;                                          \
+        block->next_free = hv->free_blocks;                           \
+        hv->free_blocks = block;                                      \
+    }                                                                 \
+    --(hv->count);                                                    \
+}
+
+/**
+ * @brief destroy values, free all blocks and set fields
+ * at zero except destroy function
+ * @param hv pointer to hive
+ */
+#define da_hive_free(type) DA_FUNC_NAME(hive_free, type)
+#define DA_DECLARE_HIVE_FREE(type) \
+void da_hive_free(type)(           \
+struct DA_HIVE_STRUCT_NAME(type)* hv)
+#define DA_DEFINE_HIVE_FREE(type)         \
+DA_DECLARE_HIVE_FREE(type) {              \
+    if (hv->dtor != NULL)                 \
+        DA_HIVE_FOREACH(type, item, hv)   \
+            hv->dtor(item);               \
+    DA_FORLOOP(i, 0, hv->blocks.count) {  \
+        free(hv->blocks.items[i]->cells); \
+        free(hv->blocks.items[i]->skip);  \
+        free(hv->blocks.items[i]);        \
+    }                                     \
+    free(hv->blocks.items);               \
+    void (*dtor)(type*) = hv->dtor;       \
+    memset(hv, 0, sizeof(*hv));           \
+    hv->dtor = dtor;                      \
+}
+
+/* Counter of owners, atomic if threads enabled, for implementation */
+#ifdef DA_ENABLE_THREADS
+#define DA_IMPL_REFCOUNT _Atomic size_t
+#else
+#define DA_IMPL_REFCOUNT size_t
+#endif
+
+/**
+ * Copy-on-write array: items in refcounted chunks of
+ * DA_COW_CHUNK_SIZE items, table of chunks refcounted too,
+ * snapshot share table, write copy shared table and touched
+ * chunk only, items copied bitwise, so no destroy function,
+ * initialized by {0}
+ */
+#define DA_COW_STRUCT_NAME(type) da_cow_struct_ ## type
+#define DA_DECLARE_COW(type, name) \
+typedef struct DA_COW_STRUCT_NAME(type) name;
+#define DA_DEFINE_COW(type, name)                                \
+DA_DECLARE_COW(type, name)                                       \
+struct DA_FUNC_NAME(cow_chunk, type) {                           \
+    DA_IMPL_REFCOUNT refs;                                       \
+    type items[DA_COW_CHUNK_SIZE];                               \
+};                                                               \
+struct DA_FUNC_NAME(cow_table, type) {                           \
+    DA_IMPL_REFCOUNT refs;                                       \
+    size_t capacity;                                             \
+    struct DA_FUNC_NAME(cow_chunk, type)* chunks[];              \
+};                                                               \
+struct DA_COW_STRUCT_NAME(type) {                                \
+    struct DA_FUNC_NAME(cow_table, type)* table;                 \
+    size_t count;                                                \
+};                                                               \
+static inline void DA_FUNC_NAME(cow_release, type)(              \
+struct DA_FUNC_NAME(cow_table, type)* table, size_t chunks) {    \
+    if (table == NULL || --(table->refs) != 0) return;           \
+    DA_FORLOOP(i, 0, chunks)                                     \
+        if (--(table->chunks[i]->refs) == 0)                     \
+            free(table->chunks[i]);                              \
+    free(table);                                                 \
+}                                                                \
+static inline void DA_FUNC_NAME(cow_own_table, type)(            \
+struct DA_COW_STRUCT_NAME(type)* cw, size_t capacity) {          \
+    struct DA_FUNC_NAME(cow_table, type)* table = cw->table;     \
+    size_t chunks = (cw->count + DA_COW_CHUNK_SIZE - 1)          \
+        / DA_COW_CHUNK_SIZE;                                     \
+    if (table != NULL && table->refs == 1) {                     \
+        if (table->capacity >= capacity) return;                 \
+        table = realloc(table, sizeof(*table)                    \
+            + capacity * sizeof(table->chunks[0]));              \
+        assert(table != NULL && "Not memory");                   \
+        table->capacity = capacity;                              \
+        cw->table = table;                                       \
+        return;                                                  \
+    }                                                            \
+    if (table != NULL && capacity < table->capacity)             \
+        capacity = table->capacity;                              \
+    struct DA_FUNC_NAME(cow_table, type)* own = malloc(          \
+        sizeof(*own) + capacity * sizeof(own->chunks[0]));       \
+    assert(own != NULL && "Not memory");                         \
+    own->refs = 1;                                               \
+    own->capacity = capacity;                                    \
+    DA_FORLOOP(i, 0, chunks) {                                   \
+        own->chunks[i] = table->chunks[i];                       \
+        ++(own->chunks[i]->refs);                                \
+    }                                                            \
+    DA_FUNC_NAME(cow_release, type)(table, chunks);              \
+    cw->table = own;                                             \
+}                                                                \
+static inline type* DA_FUNC_NAME(cow_own_item, type)(            \
+struct DA_COW_STRUCT_NAME(type)* cw, size_t index) {             \
+    DA_FUNC_NAME(cow_own_table, type)(cw, 0);                    \
+    struct DA_FUNC_NAME(cow_chunk, type)** chunk =               \
+        &cw->table->chunks[index / DA_COW_CHUNK_SIZE];           \
+    if ((*chunk)->refs != 1) {                                   \
+        struct DA_FUNC_NAME(cow_chunk, type)* own =              \
+            malloc(sizeof(*own));                                \
+        assert(own != NULL && "Not memory");                     \
+        own->refs = 1;                                           \
+        memcpy(own->items, (*chunk)->items, sizeof(own->items)); \
+        if (--((*chunk)->refs) == 0) free(*chunk);               \
+        *chunk = own;                                            \
+    }                                                            \
+    return &(*chunk)->items[index % DA_COW_CHUNK_SIZE];          \
+}
+
+/**
+ * @brief pointer to item at `index` for read, O(1)
+ * @param cw pointer to copy-on-write array
+ * @param index valid index in range [0, `cw.count`)
+ */
+#define da_cow_at(type) DA_FUNC_NAME(cow_at, type)
+#define DA_DECLARE_COW_AT(type)            \
+const type* da_cow_at(type)(               \
+const struct DA_COW_STRUCT_NAME(type)* cw, \
+size_t index)
+#define DA_DEFINE_COW_AT(type)                           \
+DA_DECLARE_COW_AT(type) {                                \
+    assert(index < cw->count && "Out of range");         \
+    return &cw->table->chunks[index / DA_COW_CHUNK_SIZE] \
+        ->items[index % DA_COW_CHUNK_SIZE];              \
+}
+
+/**
+ * @brief set item at `index` to `value`, copy table and chunk
+ * of item if they shared with snapshots
+ * @param cw pointer to copy-on-write array
+ * @param index valid index in range [0, `cw.count`)
+ * @param value new value
+ */
+#define da_cow_set(type) DA_FUNC_NAME(cow_set, type)
+#define DA_DECLARE_COW_SET(type)     \
+void da_cow_set(type)(               \
+struct DA_COW_STRUCT_NAME(type)* cw, \
+size_t index, type value)
+#define DA_DEFINE_COW_SET(type)                           \
+DA_DECLARE_COW_SET(type) {                                \
+    assert(index < cw->count && "Out of range");          \
+    *DA_FUNC_NAME(cow_own_item, type)(cw, index) = value; \
+}
+
+/**
+ * @brief add `value` to end of `cw`, copy table and last
+ * chunk if they shared with snapshots
+ * @param cw pointer to copy-on-write array
+ * @param value value for append
+ */
+#define da_cow_append(type) DA_FUNC_NAME(cow_append, type)
+#define DA_DECLARE_COW_APPEND(type)  \
+void da_cow_append(type)(            \
+struct DA_COW_STRUCT_NAME(type)* cw, \
+type value)
+#define DA_DEFINE_COW_APPEND(type)                                    \
+DA_DECLARE_COW_APPEND(type) {                                         \
+    size_t chunk = cw->count / DA_COW_CHUNK_SIZE;                     \
+    if (cw->count % DA_COW_CHUNK_SIZE != 0) {                         \
+        *DA_FUNC_NAME(cow_own_item, type)(cw, cw->count++) = value;   \
+        return;                                                       \
+    }                                                                 \
+    size_t capacity = cw->table != NULL ? cw->table->capacity : 0;    \
+    if (chunk >= capacity)                                            \
+        capacity += capacity == 0 ? 1 : (capacity + 1) / 2;           \
+    DA_FUNC_NAME(cow_own_table, type)(cw, capacity);                  \
+    struct DA_FUNC_NAME(cow_chunk, type)* own = malloc(sizeof(*own)); \
+    assert(own != NULL && "Not memory");                              \
+    own->refs = 1;                                                    \
+    own->items[0] = value;                                            \
+    cw->table->chunks[chunk] = own;                                   \
+    ++(cw->count);                                                    \
+}
+
+/**
+ * @brief make snapshot of `cw`, O(1), snapshot and `cw` share
+ * memory until write, free it by da_cow_free
+ * @param cw pointer to copy-on-write array
+ * @return snapshot
+ */
+#define da_cow_snapshot(type) DA_FUNC_NAME(cow_snapshot, type)
+#define DA_DECLARE_COW_SNAPSHOT(type)                  \
+struct DA_COW_STRUCT_NAME(type) da_cow_snapshot(type)( \
+const struct DA_COW_STRUCT_NAME(type)* cw)
+#define DA_DEFINE_COW_SNAPSHOT(type)            \
+DA_DECLARE_COW_SNAPSHOT(type) {                 \
+    if (cw->table != NULL) ++(cw->table->refs); \
+    return *cw;                                 \
+}
+
+/**
+ * @brief release memory of `cw` not shared with other versions
+ * and set fields at zero
+ * @param cw pointer to copy-on-write array or snapshot
+ */
+#define da_cow_free(type) DA_FUNC_NAME(cow_free, type)
+#define DA_DECLARE_COW_FREE(type) \
+void da_cow_free(type)(           \
+struct DA_COW_STRUCT_NAME(type)* cw)
+#define DA_DEFINE_COW_FREE(type)                          \
+DA_DECLARE_COW_FREE(type) {                               \
+    DA_FUNC_NAME(cow_release, type)(cw->table, (cw->count \
+        + DA_COW_CHUNK_SIZE - 1) / DA_COW_CHUNK_SIZE);    \
+    cw->table = NULL;                                     \
+    cw->count = 0;                                        \
+}
+
+/* Children of internal node of rope */
+#define DA_ROPE_FANOUT 32
+/* Capacity of rope leaf: DA_ROPE_LEAF_BYTES of items, at least 4 */
+#define DA_ROPE_LEAF_CAP(type)         \
+(DA_ROPE_LEAF_BYTES / sizeof(type) > 4 \
+    ? DA_ROPE_LEAF_BYTES / sizeof(type) : 4)
+
+/**
+ * Move items between neighbour arrays so that `left` keep `target`
+ * items, `left` has `count_left` and `right` has `count_right` items
+ */
+#define DA_IMPL_ROPE_SHIFT(left, right, count_left, count_right, target) \
+do {                                                                     \
+    if ((target) > (count_left)) {                                       \
+        size_t n_ = (target) - (count_left);                             \
+        memcpy((left) + (count_left), (right), n_ * sizeof(*(left)));    \
+        memmove((right), (right) + n_,                                   \
+            ((count_right) - n_) * sizeof(*(left)));                     \
+    } else {                                                             \
+        size_t n_ = (count_left) - (target);                             \
+        memmove((right) + n_, (right), (count_right) * sizeof(*(left))); \
+        memcpy((right), (left) + (target), n_ * sizeof(*(left)));        \
+    }                                                                    \
+} while (0)
+
+/**
+ * Rope: B+tree with implicit keys, leaves are contiguous blocks of
+ * items linked in order, internal nodes keep count of items in
+ * every child, so position found by counts in O(log n),
+ * initialized by {0}
+ */
+#define DA_ROPE_STRUCT_NAME(type) da_rope_struct_ ## type
+#define DA_DECLARE_ROPE(type, name) \
+typedef struct DA_ROPE_STRUCT_NAME(type) name;
+#define DA_DEFINE_ROPE(type, name)                                       \
+DA_DECLARE_ROPE(type, name)                                              \
+struct DA_FUNC_NAME(rope_leaf, type) {                                   \
+    size_t count;                                                        \
+    struct DA_FUNC_NAME(rope_leaf, type)* next;                          \
+    type items[DA_ROPE_LEAF_CAP(type)];                                  \
+};                                                                       \
+struct DA_FUNC_NAME(rope_node, type) {                                   \
+    size_t count;                                                        \
+    size_t sizes[DA_ROPE_FANOUT];                                        \
+    void*  children[DA_ROPE_FANOUT];                                     \
+};                                                                       \
+struct DA_ROPE_STRUCT_NAME(type) {                                       \
+    void*  root;       /* leaf if `height` = 0 */                        \
+    size_t height;                                                       \
+    size_t count;                                                        \
+    struct DA_FUNC_NAME(rope_leaf, type)* first;                         \
+    void (*dtor)(type*);                                                 \
+};                                                                       \
+static inline void* DA_FUNC_NAME(rope_insert_in, type)(                  \
+void* ptr, size_t height, size_t index, type value,                      \
+size_t* right_size) {                                                    \
+    if (height == 0) {                                                   \
+        struct DA_FUNC_NAME(rope_leaf, type)* leaf = ptr;                \
+        struct DA_FUNC_NAME(rope_leaf, type)* right = NULL;              \
+        if (leaf->count == DA_ROPE_LEAF_CAP(type)) {                     \
+            size_t half = DA_ROPE_LEAF_CAP(type) / 2;                    \
+            right = malloc(sizeof(*right));                              \
+            assert(right != NULL && "Not memory");                       \
+            right->count = leaf->count - half;                           \
+            memcpy(right->items, leaf->items + half,                     \
+                right->count * sizeof(type));                            \
+            leaf->count = half;                                          \
+            right->next = leaf->next;                                    \
+            leaf->next = right;                                          \
+            if (index > half) { leaf = right; index -= half; }           \
+        }                                                                \
+        memmove(leaf->items + index + 1, leaf->items + index,            \
+            (leaf->count - index) * sizeof(type));                       \
+        leaf->items[index] = value;                                      \
+        ++(leaf->count);                                                 \
+        if (right != NULL) *right_size = right->count;                   \
+        return right;                                                    \
+    }                                                                    \
+    struct DA_FUNC_NAME(rope_node, type)* node = ptr;                    \
+    size_t i = 0;                                                        \
+    while (i + 1 < node->count && index > node->sizes[i])                \
+        index -= node->sizes[i++];                                       \
+    size_t sub_size = 0;                                                 \
+    void* sub = DA_FUNC_NAME(rope_insert_in, type)(                      \
+        node->children[i], height - 1, index, value, &sub_size);         \
+    ++(node->sizes[i]);                                                  \
+    if (sub == NULL) return NULL;                                        \
+    node->sizes[i] -= sub_size;                                          \
+    struct DA_FUNC_NAME(rope_node, type)* right = NULL;                  \
+    if (node->count == DA_ROPE_FANOUT) {                                 \
+        size_t half = DA_ROPE_FANOUT / 2;                                \
+        right = malloc(sizeof(*right));                                  \
+        assert(right != NULL && "Not memory");                           \
+        right->count = node->count - half;                               \
+        memcpy(right->sizes, node->sizes + half,                         \
+            right->count * sizeof(size_t));                              \
+        memcpy(right->children, node->children + half,                   \
+            right->count * sizeof(void*));                               \
+        node->count = half;                                              \
+        if (i >= half) { node = right; i -= half; }                      \
+    }                                                                    \
+    memmove(node->sizes + i + 2, node->sizes + i + 1,                    \
+        (node->count - i - 1) * sizeof(size_t));                         \
+    memmove(node->children + i + 2, node->children + i + 1,              \
+        (node->count - i - 1) * sizeof(void*));                          \
+    node->sizes[i + 1] = sub_size;                                       \
+    node->children[i + 1] = sub;                                         \
+    ++(node->count);                                                     \
+    if (right != NULL) {                                                 \
+        *right_size = 0;                                                 \
+        DA_FORLOOP(k, 0, right->count) *right_size += right->sizes[k];   \
+    }                                                                    \
+    return right;                                                        \
+}                                                                        \
+static inline void DA_FUNC_NAME(rope_balance, type)(                     \
+struct DA_FUNC_NAME(rope_node, type)* node, size_t height, size_t i) {   \
+    size_t a = i + 1 < node->count ? i : i - 1;                          \
+    size_t count_i, count_a, count_b, limit;                             \
+    if (height == 1) {                                                   \
+        struct DA_FUNC_NAME(rope_leaf, type)* leaf = node->children[i];  \
+        count_i = leaf->count;                                           \
+        count_a = ((struct DA_FUNC_NAME(rope_leaf, type)*)               \
+            node->children[a])->count;                                   \
+        count_b = ((struct DA_FUNC_NAME(rope_leaf, type)*)               \
+            node->children[a + 1])->count;                               \
+        limit = DA_ROPE_LEAF_CAP(type);                                  \
+    } else {                                                             \
+        struct DA_FUNC_NAME(rope_node, type)* child = node->children[i]; \
+        count_i = child->count;                                          \
+        count_a = ((struct DA_FUNC_NAME(rope_node, type)*)               \
+            node->children[a])->count;                                   \
+        count_b = ((struct DA_FUNC_NAME(rope_node, type)*)               \
+            node->children[a + 1])->count;                               \
+        limit = DA_ROPE_FANOUT;                                          \
+    }                                                                    \
+    if (count_i >= limit / 4) return;                                    \
+    int merge = count_a + count_b <= limit - limit / 4;                  \
+    size_t target = merge ? count_a + count_b : (count_a + count_b) / 2; \
+    size_t moved = 0;                                                    \
+    if (height == 1) {                                                   \
+        struct DA_FUNC_NAME(rope_leaf, type)* left = node->children[a];  \
+        struct DA_FUNC_NAME(rope_leaf, type)* right =                    \
+            node->children[a + 1];                                       \
+        moved = target > count_a ? target - count_a : count_a - target;  \
+        DA_IMPL_ROPE_SHIFT(left->items, right->items,                    \
+            count_a, count_b, target);                                   \
+        left->count = target;                                            \
+        right->count = count_a + count_b - target;                       \
+        if (merge) left->next = right->next;                             \
+    } else {                                                             \
+        struct DA_FUNC_NAME(rope_node, type)* left = node->children[a];  \
+        struct DA_FUNC_NAME(rope_node, type)* right =                    \
+            node->children[a + 1];                                       \
+        if (target > count_a)                                            \
+            DA_FORLOOP(k, 0, target - count_a)                           \
+                moved += right->sizes[k];                                \
+        else                                                             \
+            DA_FORLOOP(k, target, count_a) moved += left->sizes[k];      \
+        DA_IMPL_ROPE_SHIFT(left->sizes, right->sizes,                    \
+            count_a, count_b, target);                                   \
+        DA_IMPL_ROPE_SHIFT(left->children, right->children,              \
+            count_a, count_b, target);                                   \
+        left->count = target;                                            \
+        right->count = count_a + count_b - target;                       \
+    }                                                                    \
+    if (target > count_a) {                                              \
+        node->sizes[a] += moved;                                         \
+        node->sizes[a + 1] -= moved;                                     \
+    } else {                                                             \
+        node->sizes[a] -= moved;                                         \
+        node->sizes[a + 1] += moved;                                     \
+    }                                                                    \
+    if (!merge) return;                                                  \
+    free(node->children[a + 1]);                                         \
+    memmove(node->sizes + a + 1, node->sizes + a + 2,                    \
+        (node->count - a - 2) * sizeof(size_t));                         \
+    memmove(node->children + a + 1, node->children + a + 2,              \
+        (node->count - a - 2) * sizeof(void*));                          \
+    --(node->count);                                                     \
+}                                                                        \
+static inline void DA_FUNC_NAME(rope_remove_in, type)(                   \
+void* ptr, size_t height, size_t index, void (*dtor)(type*)) {           \
+    if (height == 0) {                                                   \
+        struct DA_FUNC_NAME(rope_leaf, type)* leaf = ptr;                \
+        if (dtor != NULL) dtor(&leaf->items[index]);                     \
+        memmove(leaf->items + index, leaf->items + index + 1,            \
+            (leaf->count - index - 1) * sizeof(type));                   \
+        --(leaf->count);                                                 \
+        return;                                                          \
+    }                                                                    \
+    struct DA_FUNC_NAME(rope_node, type)* node = ptr;                    \
+    size_t i = 0;                                                        \
+    while (index >= node->sizes[i]) index -= node->sizes[i++];           \
+    DA_FUNC_NAME(rope_remove_in, type)(                                  \
+        node->children[i], height - 1, index, dtor);                     \
+    --(node->sizes[i]);                                                  \
+    if (node->count > 1)                                                 \
+        DA_FUNC_NAME(rope_balance, type)(node, height, i);               \
+}                                                                        \
+static inline void DA_FUNC_NAME(rope_free_in, type)(                     \
+void* ptr, size_t height) {                                              \
+    if (height > 0) {                                                    \
+        struct DA_FUNC_NAME(rope_node, type)* node = ptr;                \
+        DA_FORLOOP(i, 0, node->count)                                    \
+            DA_FUNC_NAME(rope_free_in, type)(                            \
+                node->children[i], height - 1);                          \
+    }                                                                    \
+    free(ptr);                                                           \
+}
+
+/* For loop macros over rope by leaves, `break` leave only leaf */
+#define DA_ROPE_FOREACH(type, item_ptr_name, rp)                  \
+for (struct DA_FUNC_NAME(rope_leaf, type)* item_ptr_name##_leaf = \
+    (rp)->first; item_ptr_name##_leaf != NULL;                    \
+    item_ptr_name##_leaf = item_ptr_name##_leaf->next)            \
+for (type* item_ptr_name = item_ptr_name##_leaf->items;           \
+    item_ptr_name < item_ptr_name##_leaf->items                   \
+        + item_ptr_name##_leaf->count;                            \
+    ++item_ptr_name)
+
+/**
+ * @brief pointer to item at `index`, O(log n)
+ * @param rp pointer to rope
+ * @param index valid index in range [0, `rp.count`)
+ */
+#define da_rope_at(type) DA_FUNC_NAME(rope_at, type)
+#define DA_DECLARE_ROPE_AT(type)            \
+type* da_rope_at(type)(                     \
+const struct DA_ROPE_STRUCT_NAME(type)* rp, \
+size_t index)
+#define DA_DEFINE_ROPE_AT(type)                                         \
+DA_DECLARE_ROPE_AT(type) {                                              \
+    assert(index < rp->count && "Out of range");                        \
+    void* ptr = rp->root;                                               \
+    for (size_t height = rp->height; height > 0; --height) {            \
+        struct DA_FUNC_NAME(rope_node, type)* node = ptr;               \
+        size_t i = 0;                                                   \
+        while (index >= node->sizes[i]) index -= node->sizes[i++];      \
+        ptr = node->children[i];                                        \
+    }                                                                   \
+    return &((struct DA_FUNC_NAME(rope_leaf, type)*)ptr)->items[index]; \
+}
+
+/**
+ * @brief insert `value` before item at `index`, O(log n),
+ * shift items of one leaf only
+ * @param rp pointer to rope
+ * @param index valid index in range [0, `rp.count`]
+ * @param value value for insert
+ */
+#define da_rope_insert_at(type) DA_FUNC_NAME(rope_insert_at, type)
+#define DA_DECLARE_ROPE_INSERT_AT(type) \
+void da_rope_insert_at(type)(           \
+struct DA_ROPE_STRUCT_NAME(type)* rp,   \
+size_t index, type value)
+#define DA_DEFINE_ROPE_INSERT_AT(type)                    \
+DA_DECLARE_ROPE_INSERT_AT(type) {                         \
+    assert(index <= rp->count && "Out of range");         \
+    if (rp->root == NULL) {                               \
+        rp->first = malloc(sizeof(*rp->first));           \
+        assert(rp->first != NULL && "Not memory");        \
+        rp->first->count = 0;                             \
+        rp->first->next = NULL;                           \
+        rp->root = rp->first;                             \
+        rp->height = 0;                                   \
+    }                                                     \
+    size_t right_size = 0;                                \
+    void* right = DA_FUNC_NAME(rope_insert_in, type)(     \
+        rp->root, rp->height, index, value, &right_size); \
+    ++(rp->count);                                        \
+    if (right != NULL) {                                  \
+        struct DA_FUNC_NAME(rope_node, type)* root =      \
+            malloc(sizeof(*root));                        \
+        assert(root != NULL && "Not memory");             \
+        root->count = 2;                                  \
+        root->sizes[0] = rp->count - right_size;          \
+        root->sizes[1] = right_size;                      \
+        root->children[0] = rp->root;                     \
+        root->children[1] = right;                        \
+        rp->root = root;                                  \
+        ++(rp->height);                                   \
+    }                                                     \
+}
+
+/**
+ * @brief add `value` to end of `rp`, O(log n)
+ * @param rp pointer to rope
+ * @param value value for append
+ */
+#define da_rope_append(type) DA_FUNC_NAME(rope_append, type)
+#define DA_DECLARE_ROPE_APPEND(type)  \
+void da_rope_append(type)(            \
+struct DA_ROPE_STRUCT_NAME(type)* rp, \
+type value)
+#define DA_DEFINE_ROPE_APPEND(type)                \
+DA_DECLARE_ROPE_APPEND(type) {                     \
+    da_rope_insert_at(type)(rp, rp->count, value); \
+}
+
+/**
+ * @brief destroy item at `index`, O(log n), shift items of one
+ * leaf only, small leaves and nodes merged with neighbour
+ * or take items from it, so all except root at least 1/4 full
+ * @param rp pointer to rope
+ * @param index valid index in range [0, `rp.count`)
+ */
+#define da_rope_remove_at(type) DA_FUNC_NAME(rope_remove_at, type)
+#define DA_DECLARE_ROPE_REMOVE_AT(type) \
+void da_rope_remove_at(type)(           \
+struct DA_ROPE_STRUCT_NAME(type)* rp,   \
+size_t index)
+#define DA_DEFINE_ROPE_REMOVE_AT(type)                                \
+DA_DECLARE_ROPE_REMOVE_AT(type) {                                     \
+    assert(index < rp->count && "Out of range");                      \
+    DA_FUNC_NAME(rope_remove_in, type)(                               \
+        rp->root, rp->height, index, rp->dtor);                       \
+    --(rp->count);                                                    \
+    while (rp->height > 0 && ((struct DA_FUNC_NAME(rope_node, type)*) \
+        rp->root)->count == 1) {                                      \
+        void* root = rp->root;                                        \
+        rp->root = ((struct DA_FUNC_NAME(rope_node, type)*)           \
+            root)->children[0];                                       \
+        free(root);                                                   \
+        --(rp->height);                                               \
+    }                                                                 \
+}
+
+/**
+ * @brief destroy items, free all nodes and set fields
+ * at zero except destroy function
+ * @param rp pointer to rope
+ */
+#define da_rope_free(type) DA_FUNC_NAME(rope_free, type)
+#define DA_DECLARE_ROPE_FREE(type) \
+void da_rope_free(type)(           \
+struct DA_ROPE_STRUCT_NAME(type)* rp)
+#define DA_DEFINE_ROPE_FREE(type)                               \
+DA_DECLARE_ROPE_FREE(type) {                                    \
+    if (rp->dtor != NULL)                                       \
+        DA_ROPE_FOREACH(type, item, rp)                         \
+            rp->dtor(item);                                     \
+    if (rp->root != NULL)                                       \
+        DA_FUNC_NAME(rope_free_in, type)(rp->root, rp->height); \
+    rp->root = NULL;                                            \
+    rp->first = NULL;                                           \
+    rp->height = 0;                                             \
+    rp->count = 0;                                              \
+}
+
+#ifdef DA_ENABLE_THREADS
+
+/* Count of samples per part for choose splitters, for implementation */
+#define DA_PARALLEL_SORT_OVERSAMPLE 64
+/* Parts of sort and scan per worker for balance, for implementation */
+#define DA_PARALLEL_PARTS_PER_THREAD 4
+/* Chunks per worker in parallel loops for balance, for implementation */
+#define DA_PARALLEL_CHUNKS_PER_THREAD 16
+
+/**
+ * @brief sort items of `da` on workers of `pool` by sample sort,
+ * order set by `less` macro from DA_DEFINE_PARALLEL_SORT,
+ * if count items less than DA_PARALLEL_SORT_THRESHOLD,
+ * `pool` is NULL or not enough memory, sort on calling
+ * thread (not stable)
+ * @param da pointer to dynamic array
+ * @param pool pointer to thread pool or NULL
+ */
+#define da_parallel_sort(type) DA_FUNC_NAME(parallel_sort, type)
+#define DA_DECLARE_PARALLEL_SORT(type) \
+void da_parallel_sort(type)(           \
+struct DA_STRUCT_NAME(type)* da,       \
+da_pool* pool)
+/* Need definition of da_sort_range for passed type */
+#define DA_DEFINE_PARALLEL_SORT(type, less)                           \
+struct DA_FUNC_NAME(psort_task, type) {                               \
+    type* items;           /* source items */                         \
+    type* buffer;          /* place for buckets */                    \
+    const type* splitters; /* nparts - 1 values */                    \
+    size_t count;                                                     \
+    size_t nparts;         /* parts of input and buckets */           \
+    size_t* offsets;       /* [part][bucket] */                       \
+    int stage;                                                        \
+};                                                                    \
+static size_t DA_FUNC_NAME(psort_bucket, type)(                       \
+const type* splitters, size_t nsplit, type value, size_t index) {     \
+    /* count of splitters not greater than value */                   \
+    size_t base = 0;                                                  \
+    while (nsplit > 0) {                                              \
+        size_t half = nsplit / 2;                                     \
+        if (!less(value, splitters[base + half])) {                   \
+            base += half + 1;                                         \
+            nsplit -= half + 1;                                       \
+        } else nsplit = half;                                         \
+    }                                                                 \
+    if (base == 0 || less(splitters[base - 1], value)) return base;   \
+    /* value equal to splitters: spread by index over their buckets,  \
+       buckets between equal splitters hold only this value */        \
+    size_t low = 0;                                                   \
+    nsplit = base - 1;                                                \
+    while (nsplit > 0) {                                              \
+        size_t half = nsplit / 2;                                     \
+        if (less(splitters[low + half], value)) {                     \
+            low += half + 1;                                          \
+            nsplit -= half + 1;                                       \
+        } else nsplit = half;                                         \
+    }                                                                 \
+    return low + index % (base - low + 1);                            \
+}                                                                     \
+static void DA_FUNC_NAME(psort_job, type)(                            \
+void* ptr, size_t first, size_t last) {                               \
+    struct DA_FUNC_NAME(psort_task, type)* task = ptr;                \
+    size_t n = task->nparts;                                          \
+    DA_FORLOOP(id, first, last) {                                     \
+        size_t* offsets = task->offsets + id * n;                     \
+        size_t begin = task->count * id / n;                          \
+        size_t end = task->count * (id + 1) / n;                      \
+        switch (task->stage) {                                        \
+        case 0: /* count items of part for every bucket */            \
+            DA_FORLOOP(i, begin, end)                                 \
+                ++offsets[DA_FUNC_NAME(psort_bucket, type)(           \
+                    task->splitters, n - 1, task->items[i], i)];      \
+            break;                                                    \
+        case 1: /* scatter items of part to buckets */                \
+            DA_FORLOOP(i, begin, end)                                 \
+                task->buffer[offsets[DA_FUNC_NAME(psort_bucket,       \
+                    type)(task->splitters, n - 1,                     \
+                    task->items[i], i)]++]                            \
+                    = task->items[i];                                 \
+            break;                                                    \
+        case 2: /* sort bucket `id` and move it back */               \
+            begin = task->offsets[id];                                \
+            end = id + 1 < n ? task->offsets[id + 1] : task->count;   \
+            da_sort_range(type)(task->buffer + begin, end - begin);   \
+            memcpy(task->items + begin, task->buffer + begin,         \
+                (end - begin) * sizeof(*task->items));                \
+            break;                                                    \
+        }                                                             \
+    }                                                                 \
+}                                                                     \
+DA_DECLARE_PARALLEL_SORT(type) {                                      \
+    size_t count = da->count;                                         \
+    size_t nparts = da_pool_threads(pool)                             \
+        * DA_PARALLEL_PARTS_PER_THREAD;                               \
+    if (nparts > count) nparts = count;                               \
+    if (da_pool_threads(pool) < 2                                     \
+    || count < DA_PARALLEL_SORT_THRESHOLD) {                          \
+        da_sort_range(type)(da->items, count);                        \
+        return;                                                       \
+    }                                                                 \
+    size_t nsample = nparts * DA_PARALLEL_SORT_OVERSAMPLE;            \
+    if (nsample > count) nsample = count;                             \
+    struct DA_FUNC_NAME(psort_task, type) task = {                    \
+        da->items, malloc(count * sizeof(*da->items)), NULL,          \
+        count, nparts,                                                \
+        calloc(nparts * nparts, sizeof(size_t)), 0                    \
+    };                                                                \
+    type* samples = malloc(nsample * sizeof(*da->items));             \
+    if (task.buffer == NULL || task.offsets == NULL                   \
+    || samples == NULL) {                                             \
+        da_sort_range(type)(da->items, count);                        \
+    } else {                                                          \
+        /* choose nparts - 1 splitters from regular sample */         \
+        DA_FORLOOP(i, 0, nsample)                                     \
+            samples[i] = da->items[count / nsample * i];              \
+        da_sort_range(type)(samples, nsample);                        \
+        DA_FORLOOP(i, 1, nparts)                                      \
+            samples[i - 1] = samples[nsample * i / nparts];           \
+        task.splitters = samples;                                     \
+        da_pool_parallel_for(pool, nparts, 1,                         \
+            DA_FUNC_NAME(psort_job, type), &task);                    \
+        /* counts to offsets: bucket-major, part-minor order */       \
+        size_t offset = 0;                                            \
+        DA_FORLOOP(b, 0, nparts)                                      \
+            DA_FORLOOP(p, 0, nparts) {                                \
+                size_t bucket = task.offsets[p * nparts + b];         \
+                task.offsets[p * nparts + b] = offset;                \
+                offset += bucket;                                     \
+            }                                                         \
+        task.stage = 1;                                               \
+        da_pool_parallel_for(pool, nparts, 1,                         \
+            DA_FUNC_NAME(psort_job, type), &task);                    \
+        /* after scatter offsets of last part is bucket ends */       \
+        task.offsets[0] = 0;                                          \
+        DA_FORLOOP(b, 1, nparts)                                      \
+            task.offsets[b] = task.offsets[                           \
+                (nparts - 1) * nparts + b - 1];                       \
+        task.stage = 2;                                               \
+        da_pool_parallel_for(pool, nparts, 1,                         \
+            DA_FUNC_NAME(psort_job, type), &task);                    \
+    }                                                                 \
+    free(task.buffer);                                                \
+    free(task.offsets);                                               \
+    free(samples);                                                    \
+}
+
+/**
+ * @brief same as da_inclusive_scan, but on workers of `pool`:
+ * first pass sum parts, second pass scan parts with offset,
+ * if count items less than DA_PARALLEL_SCAN_THRESHOLD or
+ * `pool` is NULL scan on calling thread (for floating point
+ * types order of additions differ from serial scan)
+ * @param dst pointer to destination dynamic array
+ * @param src pointer to source dynamic array
+ * @param pool pointer to thread pool or NULL
+ */
+#define da_parallel_inclusive_scan(type) \
+DA_FUNC_NAME(parallel_inclusive_scan, type)
+/**
+ * @brief same as da_exclusive_scan, but on workers of `pool`,
+ * see da_parallel_inclusive_scan
+ * @param dst pointer to destination dynamic array
+ * @param src pointer to source dynamic array
+ * @param pool pointer to thread pool or NULL
+ */
+#define da_parallel_exclusive_scan(type) \
+DA_FUNC_NAME(parallel_exclusive_scan, type)
+#define DA_DECLARE_PARALLEL_SCAN(type)  \
+void da_parallel_inclusive_scan(type)(  \
+struct DA_STRUCT_NAME(type)* dst,       \
+const struct DA_STRUCT_NAME(type)* src, \
+da_pool* pool);                         \
+void da_parallel_exclusive_scan(type)(  \
+struct DA_STRUCT_NAME(type)* dst,       \
+const struct DA_STRUCT_NAME(type)* src, \
+da_pool* pool)
+/* Need definition of DA_DEFINE_SCAN for passed type */
+#define DA_DEFINE_PARALLEL_SCAN(type)                           \
+struct DA_FUNC_NAME(pscan_task, type) {                         \
+    type* out;                                                  \
+    const type* in;                                             \
+    size_t count;                                               \
+    size_t nparts;                                              \
+    type* carry;   /* part sums, then part offsets */           \
+    int exclusive;                                              \
+    int stage;                                                  \
+};                                                              \
+static void DA_FUNC_NAME(pscan_job, type)(                      \
+void* ptr, size_t first, size_t last) {                         \
+    struct DA_FUNC_NAME(pscan_task, type)* task = ptr;          \
+    DA_FORLOOP(id, first, last) {                               \
+        size_t begin = task->count * id / task->nparts;         \
+        size_t end = task->count * (id + 1) / task->nparts;     \
+        if (task->stage == 0) {                                 \
+            type sum = 0;                                       \
+            DA_FORLOOP(i, begin, end) sum += task->in[i];       \
+            task->carry[id] = sum;                              \
+        } else                                                  \
+            DA_FUNC_NAME(scan_range, type)(task->out + begin,   \
+                task->in + begin, end - begin,                  \
+                task->carry[id], task->exclusive);              \
+    }                                                           \
+}                                                               \
+static void DA_FUNC_NAME(parallel_scan, type)(                  \
+struct DA_STRUCT_NAME(type)* dst,                               \
+const struct DA_STRUCT_NAME(type)* src,                         \
+da_pool* pool, int exclusive) {                                 \
+    size_t count = src->count;                                  \
+    DA_FUNC_NAME(scan_prepare, type)(dst, src);                 \
+    struct DA_FUNC_NAME(pscan_task, type) task = {              \
+        dst->items, src->items, count,                          \
+        da_pool_threads(pool) * DA_PARALLEL_PARTS_PER_THREAD,   \
+        NULL, exclusive, 0                                      \
+    };                                                          \
+    if (da_pool_threads(pool) > 1                               \
+    && count >= DA_PARALLEL_SCAN_THRESHOLD)                     \
+        task.carry = malloc(task.nparts * sizeof(*task.carry)); \
+    if (task.carry == NULL) {                                   \
+        DA_FUNC_NAME(scan_range, type)(                         \
+            dst->items, src->items, count, 0, exclusive);       \
+        return;                                                 \
+    }                                                           \
+    /* last part sum is not needed */                           \
+    da_pool_parallel_for(pool, task.nparts - 1, 1,              \
+        DA_FUNC_NAME(pscan_job, type), &task);                  \
+    type offset = 0;                                            \
+    DA_FORLOOP(p, 0, task.nparts - 1) {                         \
+        type sum = task.carry[p];                               \
+        task.carry[p] = offset;                                 \
+        offset += sum;                                          \
+    }                                                           \
+    task.carry[task.nparts - 1] = offset;                       \
+    task.stage = 1;                                             \
+    da_pool_parallel_for(pool, task.nparts, 1,                  \
+        DA_FUNC_NAME(pscan_job, type), &task);                  \
+    free(task.carry);                                           \
+}                                                               \
+void da_parallel_inclusive_scan(type)(                          \
+struct DA_STRUCT_NAME(type)* dst,                               \
+const struct DA_STRUCT_NAME(type)* src,                         \
+da_pool* pool) {                                                \
+    DA_FUNC_NAME(parallel_scan, type)(dst, src, pool, 0);       \
+}                                                               \
+void da_parallel_exclusive_scan(type)(                          \
+struct DA_STRUCT_NAME(type)* dst,                               \
+const struct DA_STRUCT_NAME(type)* src,                         \
+da_pool* pool) {                                                \
+    DA_FUNC_NAME(parallel_scan, type)(dst, src, pool, 1);       \
+}
+
+/**
+ * @brief call `fn` for every item of `da` on workers of `pool`,
+ * items split into chunks with borders at cache line boundaries,
+ * so workers do not write to one cache line, idle workers steal
+ * chunks from busy, if `pool` is NULL loop run on calling thread
+ * @param da pointer to dynamic array
+ * @param fn function as `void fn(type* item, void* ctx)`
+ * @param ctx user data passed to `fn`
+ * @param pool pointer to thread pool or NULL
+ */
+#define da_parallel_for(type) DA_FUNC_NAME(parallel_for, type)
+#define DA_DECLARE_PARALLEL_FOR(type) \
+void da_parallel_for(type)(           \
+struct DA_STRUCT_NAME(type)* da,      \
+void (*fn)(type*, void*),             \
+void* ctx,                            \
+da_pool* pool)
+#define DA_DEFINE_PARALLEL_FOR(type)                                 \
+struct DA_FUNC_NAME(pfor_task, type) {                               \
+    type* items;                                                     \
+    size_t count;                                                    \
+    size_t head;  /* items before first aligned border */            \
+    size_t chunk; /* items in chunk */                               \
+    void (*fn)(type*, void*);                                        \
+    void* ctx;                                                       \
+};                                                                   \
+static size_t DA_FUNC_NAME(pfor_border, type)(                       \
+const struct DA_FUNC_NAME(pfor_task, type)* task, size_t chunk) {    \
+    /* chunk 0 is [0, head), it may be empty */                      \
+    size_t border = chunk == 0 ? 0                                   \
+        : task->head + (chunk - 1) * task->chunk;                    \
+    return border < task->count ? border : task->count;              \
+}                                                                    \
+static void DA_FUNC_NAME(pfor_job, type)(                            \
+void* ptr, size_t first, size_t last) {                              \
+    struct DA_FUNC_NAME(pfor_task, type)* task = ptr;                \
+    size_t end = DA_FUNC_NAME(pfor_border, type)(task, last);        \
+    DA_FORLOOP(i, DA_FUNC_NAME(pfor_border, type)(task, first), end) \
+        task->fn(&task->items[i], task->ctx);                        \
+}                                                                    \
+DA_DECLARE_PARALLEL_FOR(type) {                                      \
+    struct DA_FUNC_NAME(pfor_task, type) task = {                    \
+        da->items, da->count, 0, 1, fn, ctx                          \
+    };                                                               \
+    /* chunk is whole count of cache lines if it possible */         \
+    size_t line = DA_CACHE_LINE % sizeof(type) == 0                  \
+        ? DA_CACHE_LINE / sizeof(type) : 1;                          \
+    if (line > 1 && (uintptr_t)da->items % sizeof(type) == 0)        \
+        task.head = (DA_CACHE_LINE - (uintptr_t)da->items            \
+            % DA_CACHE_LINE) % DA_CACHE_LINE / sizeof(type);         \
+    if (task.head > task.count) task.head = task.count;              \
+    size_t lines = (task.count - task.head + line - 1) / line;       \
+    size_t per_chunk = lines / (da_pool_threads(pool)                \
+        * DA_PARALLEL_CHUNKS_PER_THREAD);                            \
+    task.chunk = (per_chunk > 0 ? per_chunk : 1) * line;             \
+    size_t nchunks = 1 + (task.count - task.head                     \
+        + task.chunk - 1) / task.chunk;                              \
+    da_pool_parallel_for(pool, nchunks, 1,                           \
+        DA_FUNC_NAME(pfor_job, type), &task);                        \
+}
+
+/**
+ * Dynamic array for many producers on segments as in segmented
+ * array: slot reserved by one atomic increment of `count`,
+ * segments never move, so growth only install missing segment
+ * by compare-and-swap, `count` on own cache line, iterate
+ * by DA_SEGMENTED_FOREACH after producers finished,
+ * initialized by {0}
+ */
+#define DA_CONCURRENT_STRUCT_NAME(type) da_concurrent_struct_ ## type
+#define DA_DECLARE_CONCURRENT_STRUCT(type, name) \
+typedef struct DA_CONCURRENT_STRUCT_NAME(type) name;
+#define DA_DEFINE_CONCURRENT_STRUCT(type, name)                         \
+DA_DECLARE_CONCURRENT_STRUCT(type, name)                                \
+struct DA_CONCURRENT_STRUCT_NAME(type) {                                \
+    type* _Atomic segments[DA_SEGMENT_COUNT];                           \
+    void (*dtor)(type*);                                                \
+    _Alignas(DA_CACHE_LINE) _Atomic size_t count;  /* reserved slots */ \
+};
+
+/**
+ * @brief pointer to item at `index`, O(1),
+ * call only when no producers
+ * @param da pointer to concurrent dynamic array
+ * @param index valid index in range [0, `da.count`)
+ */
+#define da_concurrent_at(type) DA_FUNC_NAME(concurrent_at, type)
+#define DA_DECLARE_CONCURRENT_AT(type)            \
+type* da_concurrent_at(type)(                     \
+const struct DA_CONCURRENT_STRUCT_NAME(type)* da, \
+size_t index)
+#define DA_DEFINE_CONCURRENT_AT(type)                          \
+DA_DECLARE_CONCURRENT_AT(type) {                               \
+    assert(index < atomic_load(&da->count) && "Out of range"); \
+    size_t k = DA_IMPL_SEGMENT_OF(index);                      \
+    return &atomic_load(&da->segments[k])[                     \
+        DA_IMPL_SEGMENT_OFFSET(index, k)];                     \
+}
+
+/**
+ * @brief add `value` to end of `da` from any thread, lock-free:
+ * one atomic increment of `count` and load of segment, first
+ * producers in new segment allocate it and one of them install
+ * it, others free own copy, items is ready for read after
+ * all producers finished
+ * @param da pointer to concurrent dynamic array
+ * @param value value for append
+ * @return index of appended item
+ */
+#define da_concurrent_append(type) DA_FUNC_NAME(concurrent_append, type)
+#define DA_DECLARE_CONCURRENT_APPEND(type)  \
+size_t da_concurrent_append(type)(          \
+struct DA_CONCURRENT_STRUCT_NAME(type)* da, \
+type value)
+#define DA_DEFINE_CONCURRENT_APPEND(type)                        \
+static type* DA_FUNC_NAME(concurrent_segment, type)(             \
+struct DA_CONCURRENT_STRUCT_NAME(type)* da, size_t k) {          \
+    type* segment = malloc(DA_SEGMENT_SIZE(k) * sizeof(type));   \
+    assert(segment != NULL && "Not memory");                     \
+    type* installed = NULL;                                      \
+    if (atomic_compare_exchange_strong(                          \
+        &da->segments[k], &installed, segment)) return segment;  \
+    free(segment);                                               \
+    return installed;                                            \
+}                                                                \
+DA_DECLARE_CONCURRENT_APPEND(type) {                             \
+    size_t index = atomic_fetch_add_explicit(                    \
+        &da->count, 1, memory_order_relaxed);                    \
+    size_t k = DA_IMPL_SEGMENT_OF(index);                        \
+    type* segment = atomic_load_explicit(                        \
+        &da->segments[k], memory_order_acquire);                 \
+    if (segment == NULL)                                         \
+        segment = DA_FUNC_NAME(concurrent_segment, type)(da, k); \
+    segment[DA_IMPL_SEGMENT_OFFSET(index, k)] = value;           \
+    return index;                                                \
+}
+
+/**
+ * @brief destroy items, free segments and set fields at zero,
+ * call only when no producers
+ * @param da pointer to concurrent dynamic array
+ */
+#define da_concurrent_free(type) DA_FUNC_NAME(concurrent_free, type)
+#define DA_DECLARE_CONCURRENT_FREE(type) \
+void da_concurrent_free(type)(           \
+struct DA_CONCURRENT_STRUCT_NAME(type)* da)
+#define DA_DEFINE_CONCURRENT_FREE(type)       \
+DA_DECLARE_CONCURRENT_FREE(type) {            \
+    if (da->dtor != NULL)                     \
+        DA_SEGMENTED_FOREACH(type, item, da)  \
+            da->dtor(item);                   \
+    DA_FORLOOP(k, 0, DA_SEGMENT_COUNT) {      \
+        free(da->segments[k]);                \
+        atomic_store(&da->segments[k], NULL); \
+    }                                         \
+    atomic_store(&da->count, 0);              \
+}
+
+/**
+ * Set of 'da' with one shard per thread, every shard on own
+ * cache lines, so threads append without atomics and false
+ * sharing, need DA_DEFINE_STRUCT for passed type
+ */
+#define DA_SHARDED_STRUCT_NAME(type) da_sharded_struct_ ## type
+#define DA_DECLARE_SHARDED_STRUCT(type, name) \
+typedef struct DA_SHARDED_STRUCT_NAME(type) name;
+#define DA_DEFINE_SHARDED_STRUCT(type, name)  \
+DA_DECLARE_SHARDED_STRUCT(type, name)         \
+struct DA_FUNC_NAME(shard, type) {            \
+    _Alignas(DA_CACHE_LINE)                   \
+    struct DA_STRUCT_NAME(type) da;           \
+};                                            \
+struct DA_SHARDED_STRUCT_NAME(type) {         \
+    struct DA_FUNC_NAME(shard, type)* shards; \
+    size_t count;                             \
+};
+
+/**
+ * @brief allocate `count` empty shards with destroy function `dtor`
+ * @param sh pointer to sharded array
+ * @param count count of shards, usually count of threads, may be 0
+ * @param dtor destroy function for items or NULL
+ */
+#define da_sharded_init(type) DA_FUNC_NAME(sharded_init, type)
+#define DA_DECLARE_SHARDED_INIT(type)    \
+void da_sharded_init(type)(              \
+struct DA_SHARDED_STRUCT_NAME(type)* sh, \
+size_t count, void (*dtor)(type*))
+#define DA_DEFINE_SHARDED_INIT(type)                    \
+DA_DECLARE_SHARDED_INIT(type) {                         \
+    sh->shards = NULL;                                  \
+    sh->count = count;                                  \
+    /* aligned_alloc may return NULL for 0 bytes */     \
+    if (count == 0) return;                             \
+    sh->shards = aligned_alloc(DA_CACHE_LINE,           \
+        count * sizeof(*sh->shards));                   \
+    assert(sh->shards != NULL && "Not memory");         \
+    memset(sh->shards, 0, count * sizeof(*sh->shards)); \
+    DA_FORLOOP(i, 0, count)                             \
+        sh->shards[i].da.dtor = dtor;                   \
+}
+
+/**
+ * @brief add `value` to end of shard `shard`, only one
+ * thread may append to one shard at the same time
+ * @param sh pointer to sharded array
+ * @param shard index of shard in range [0, `sh.count`)
+ * @param value value for append
+ */
+#define da_sharded_append(type) DA_FUNC_NAME(sharded_append, type)
+#define DA_DECLARE_SHARDED_APPEND(type)  \
+void da_sharded_append(type)(            \
+struct DA_SHARDED_STRUCT_NAME(type)* sh, \
+size_t shard, type value)
+#define DA_DEFINE_SHARDED_APPEND(type)                       \
+DA_DECLARE_SHARDED_APPEND(type) {                            \
+    assert(shard < sh->count && "Out of range");             \
+    struct DA_STRUCT_NAME(type)* da = &sh->shards[shard].da; \
+    DA_GROW(da, da->count + 1);                              \
+    da->items[da->count++] = value;                          \
+}
+
+/**
+ * @brief move items of all shards to end of `dst` in shard order,
+ * `dst` reserve place once, shards copied by memcpy on workers
+ * of `pool` (or on calling thread if NULL), shards become
+ * empty and save capacity
+ * @param sh pointer to sharded array
+ * @param dst pointer to destination dynamic array
+ * @param pool pointer to thread pool or NULL
+ */
+#define da_sharded_collect(type) DA_FUNC_NAME(sharded_collect, type)
+#define DA_DECLARE_SHARDED_COLLECT(type) \
+void da_sharded_collect(type)(           \
+struct DA_SHARDED_STRUCT_NAME(type)* sh, \
+struct DA_STRUCT_NAME(type)* dst,        \
+da_pool* pool)
+#define DA_DEFINE_SHARDED_COLLECT(type)                     \
+struct DA_FUNC_NAME(collect_task, type) {                   \
+    struct DA_SHARDED_STRUCT_NAME(type)* sh;                \
+    type* out;                                              \
+    size_t* offsets;                                        \
+};                                                          \
+static void DA_FUNC_NAME(collect_job, type)(                \
+void* ptr, size_t first, size_t last) {                     \
+    struct DA_FUNC_NAME(collect_task, type)* task = ptr;    \
+    DA_FORLOOP(i, first, last) {                            \
+        struct DA_STRUCT_NAME(type)* da =                   \
+            &task->sh->shards[i].da;                        \
+        if (da->count > 0)                                  \
+            memcpy(task->out + task->offsets[i], da->items, \
+                da->count * sizeof(*da->items));            \
+        da->count = 0;                                      \
+    }                                                       \
+}                                                           \
+DA_DECLARE_SHARDED_COLLECT(type) {                          \
+    if (sh->count == 0) return;                             \
+    size_t* offsets = malloc(sh->count * sizeof(size_t));   \
+    assert(offsets != NULL && "Not memory");                \
+    size_t total = 0;                                       \
+    DA_FORLOOP(i, 0, sh->count) {                           \
+        offsets[i] = total;                                 \
+        total += sh->shards[i].da.count;                    \
+    }                                                       \
+    DA_RESERVE(dst, dst->count + total);                    \
+    struct DA_FUNC_NAME(collect_task, type) task = {        \
+        sh, dst->items + dst->count, offsets                \
+    };                                                      \
+    da_pool_parallel_for(pool, sh->count, 1,                \
+        DA_FUNC_NAME(collect_job, type), &task);            \
+    dst->count += total;                                    \
+    free(offsets);                                          \
+}
+
+/**
+ * @brief destroy items and free memory of all shards
+ * @param sh pointer to sharded array
+ */
+#define da_sharded_free(type) DA_FUNC_NAME(sharded_free, type)
+#define DA_DECLARE_SHARDED_FREE(type) \
+void da_sharded_free(type)(           \
+struct DA_SHARDED_STRUCT_NAME(type)* sh)
+#define DA_DEFINE_SHARDED_FREE(type)                         \
+DA_DECLARE_SHARDED_FREE(type) {                              \
+    DA_FORLOOP(i, 0, sh->count) {                            \
+        struct DA_STRUCT_NAME(type)* da = &sh->shards[i].da; \
+        if (da->dtor != NULL)                                \
+            DA_FOREACH(type, item, da)                       \
+                da->dtor(item);                              \
+        free(da->items);                                     \
+    }                                                        \
+    free(sh->shards);                                        \
+    sh->shards = NULL;                                       \
+    sh->count = 0;                                           \
+}
+
+/* Buffer retired by writer at epoch, for implementation */
+struct da_impl_retired {
+    void*    buffer;
+    uint64_t epoch;
+};
+
+/* Reader announced epoch on own cache line, 0 if outside of read */
+struct da_impl_epoch_slot {
+    _Alignas(DA_CACHE_LINE) _Atomic uint64_t epoch;
+};
+
+/* Appends between reclaims while buffers retired, for implementation */
+#define DA_EPOCH_RECLAIM_PERIOD 64
+
+/**
+ * Dynamic array for one writer and many readers: growth copy
+ * items to new buffer and publish it, old buffer retired
+ * until all readers leave epoch of retirement^4
+ */
+#define DA_EPOCH_STRUCT_NAME(type) da_epoch_struct_ ## type
+#define DA_DECLARE_EPOCH_STRUCT(type, name) \
+typedef struct DA_EPOCH_STRUCT_NAME(type) name;
+#define DA_DEFINE_EPOCH_STRUCT(type, name) \
+DA_DECLARE_EPOCH_STRUCT(type, name)        \
+struct DA_EPOCH_STRUCT_NAME(type) {        \
+    type* _Atomic  items;                  \
+    _Atomic size_t count;                  \
+    size_t capacity;                       \
+    void (*dtor)(type*);                   \
+    _Atomic uint64_t epoch;                \
+    struct da_impl_epoch_slot* readers;    \
+    size_t readers_count;                  \
+    struct {                               \
+        struct da_impl_retired* items;     \
+        size_t count;                      \
+        size_t capacity;                   \
+    } retired;                             \
+};
+
+/**
+ * @brief allocate `readers` slots of readers and set
+ * destroy function `dtor`
+ * @param da pointer to epoch dynamic array
+ * @param readers count of reader threads
+ * @param dtor destroy function for items or NULL
+ */
+#define da_epoch_init(type) DA_FUNC_NAME(epoch_init, type)
+#define DA_DECLARE_EPOCH_INIT(type)    \
+void da_epoch_init(type)(              \
+struct DA_EPOCH_STRUCT_NAME(type)* da, \
+size_t readers, void (*dtor)(type*))
+#define DA_DEFINE_EPOCH_INIT(type)               \
+DA_DECLARE_EPOCH_INIT(type) {                    \
+    memset(da, 0, sizeof(*da));                  \
+    da->readers = aligned_alloc(DA_CACHE_LINE,   \
+        (readers > 0 ? readers : 1)              \
+            * sizeof(*da->readers));             \
+    assert(da->readers != NULL && "Not memory"); \
+    DA_FORLOOP(i, 0, readers)                    \
+        atomic_init(&da->readers[i].epoch, 0);   \
+    da->readers_count = readers;                 \
+    da->dtor = dtor;                             \
+    atomic_init(&da->epoch, 1);                  \
+}
+
+/**
+ * @brief enter to read section of reader `reader`, returned
+ * items stay valid until da_read_end, cost one seq_cst store
+ * to own cache line of reader: full barrier (`xchg` on x86,
+ * tens of cycles), so writer can not miss reader which
+ * already loaded items, for short reads keep one section
+ * over several lookups
+ * @param da pointer to epoch dynamic array
+ * @param reader index of reader in range [0, `da.readers_count`)
+ * @param count pointer for count of readable items
+ * @return pointer to items
+ */
+#define da_read_begin(type) DA_FUNC_NAME(read_begin, type)
+#define DA_DECLARE_READ_BEGIN(type)    \
+const type* da_read_begin(type)(       \
+struct DA_EPOCH_STRUCT_NAME(type)* da, \
+size_t reader, size_t* count)
+#define DA_DEFINE_READ_BEGIN(type)                               \
+DA_DECLARE_READ_BEGIN(type) {                                    \
+    assert(reader < da->readers_count && "Out of range");        \
+    atomic_store(&da->readers[reader].epoch,                     \
+        atomic_load_explicit(&da->epoch, memory_order_relaxed)); \
+    *count = atomic_load_explicit(&da->count,                    \
+        memory_order_acquire);                                   \
+    return atomic_load(&da->items);                              \
+}
+
+/**
+ * @brief leave read section of reader `reader`
+ * @param da pointer to epoch dynamic array
+ * @param reader index of reader in range [0, `da.readers_count`)
+ */
+#define da_read_end(type) DA_FUNC_NAME(read_end, type)
+#define DA_DECLARE_READ_END(type)      \
+void da_read_end(type)(                \
+struct DA_EPOCH_STRUCT_NAME(type)* da, \
+size_t reader)
+#define DA_DEFINE_READ_END(type)                          \
+DA_DECLARE_READ_END(type) {                               \
+    assert(reader < da->readers_count && "Out of range"); \
+    atomic_store_explicit(&da->readers[reader].epoch, 0,  \
+        memory_order_release);                            \
+}
+
+/**
+ * @brief free retired buffers, which no reader may hold,
+ * call only from writer; append call it on growth and every
+ * DA_EPOCH_RECLAIM_PERIOD appends while buffers retired,
+ * writer call it when appends stop, otherwise buffers stay
+ * until next append or free
+ * @param da pointer to epoch dynamic array
+ */
+#define da_epoch_reclaim(type) DA_FUNC_NAME(epoch_reclaim, type)
+#define DA_DECLARE_EPOCH_RECLAIM(type) \
+void da_epoch_reclaim(type)(           \
+struct DA_EPOCH_STRUCT_NAME(type)* da)
+#define DA_DEFINE_EPOCH_RECLAIM(type)                         \
+DA_DECLARE_EPOCH_RECLAIM(type) {                              \
+    uint64_t oldest = UINT64_MAX;                             \
+    DA_FORLOOP(i, 0, da->readers_count) {                     \
+        uint64_t epoch = atomic_load(&da->readers[i].epoch);  \
+        if (epoch != 0 && epoch < oldest) oldest = epoch;     \
+    }                                                         \
+    size_t kept = 0;                                          \
+    DA_FORLOOP(i, 0, da->retired.count) {                     \
+        if (da->retired.items[i].epoch < oldest)              \
+            free(da->retired.items[i].buffer);                \
+        else                                                  \
+            da->retired.items[kept++] = da->retired.items[i]; \
+    }                                                         \
+    da->retired.count = kept;                                 \
+}
+
+/**
+ * @brief add `value` to end of `da`, call only from writer,
+ * growth never free buffer under readers, retired buffers
+ * freed on growth and every DA_EPOCH_RECLAIM_PERIOD appends
+ * @param da pointer to epoch dynamic array
+ * @param value value for append
+ */
+#define da_epoch_append(type) DA_FUNC_NAME(epoch_append, type)
+#define DA_DECLARE_EPOCH_APPEND(type)  \
+void da_epoch_append(type)(            \
+struct DA_EPOCH_STRUCT_NAME(type)* da, \
+type value)
+#define DA_DEFINE_EPOCH_APPEND(type)                       \
+DA_DECLARE_EPOCH_APPEND(type) {                            \
+    size_t count = atomic_load_explicit(&da->count,        \
+        memory_order_relaxed);                             \
+    type* items = atomic_load_explicit(&da->items,         \
+        memory_order_relaxed);                             \
+    if (count >= da->capacity) {                           \
+        da->capacity += da->capacity == 0                  \
+            ? DA_DEFAULT_INIT_CAP                          \
+            : (da->capacity + 1) / 2;                      \
+        type* grown = malloc(da->capacity * sizeof(type)); \
+        assert(grown != NULL && "Not memory");             \
+        if (count > 0)                                     \
+            memcpy(grown, items, count * sizeof(type));    \
+        atomic_store(&da->items, grown);                   \
+        if (items != NULL) {                               \
+            DA_GROW(&da->retired, da->retired.count + 1);  \
+            da->retired.items[da->retired.count++] =       \
+                (struct da_impl_retired){                  \
+                    items, atomic_fetch_add(&da->epoch, 1) \
+                };                                         \
+            da_epoch_reclaim(type)(da);                    \
+        }                                                  \
+        items = grown;                                     \
+    } else if (da->retired.count > 0                       \
+    && count % DA_EPOCH_RECLAIM_PERIOD == 0)               \
+        da_epoch_reclaim(type)(da);                        \
+    items[count] = value;                                  \
+    atomic_store_explicit(&da->count, count + 1,           \
+        memory_order_release);                             \
+}
+
+/**
+ * @brief destroy items, free all buffers and slots of readers,
+ * call only when no readers
+ * @param da pointer to epoch dynamic array
+ */
+#define da_epoch_free(type) DA_FUNC_NAME(epoch_free, type)
+#define DA_DECLARE_EPOCH_FREE(type) \
+void da_epoch_free(type)(           \
+struct DA_EPOCH_STRUCT_NAME(type)* da)
+#define DA_DEFINE_EPOCH_FREE(type)          \
+DA_DECLARE_EPOCH_FREE(type) {               \
+    type* items = atomic_load(&da->items);  \
+    size_t count = atomic_load(&da->count); \
+    if (da->dtor != NULL)                   \
+        DA_FORLOOP(i, 0, count)             \
+            da->dtor(&items[i]);            \
+    free(items);                            \
+    DA_FORLOOP(i, 0, da->retired.count)     \
+        free(da->retired.items[i].buffer);  \
+    free(da->retired.items);                \
+    free(da->readers);                      \
+    memset(da, 0, sizeof(*da));             \
+}
+
+/**
+ * Dynamic array under seqlock for rarely updated tables: writer
+ * make sequence odd during change, readers read without writes
+ * and retry if sequence changed, buffers replaced by growth kept
+ * until free, so optimistic readers never touch freed memory,
+ * readers see `da` by `view` published at end of write,
+ * need DA_DEFINE_STRUCT for passed type, initialized by {0}
+ */
+#define DA_SEQLOCK_STRUCT_NAME(type) da_seqlock_struct_ ## type
+#define DA_DECLARE_SEQLOCK_STRUCT(type, name) \
+typedef struct DA_SEQLOCK_STRUCT_NAME(type) name;
+#define DA_DEFINE_SEQLOCK_STRUCT(type, name)             \
+DA_DECLARE_SEQLOCK_STRUCT(type, name)                    \
+struct DA_SEQLOCK_STRUCT_NAME(type) {                    \
+    struct DA_STRUCT_NAME(type) da;                      \
+    _Atomic unsigned seq;                                \
+    struct {                                             \
+        type* _Atomic items;                             \
+        _Atomic size_t count;                            \
+    } view;    /* published state of `da` for readers */ \
+    struct {                                             \
+        void** items;                                    \
+        size_t count;                                    \
+        size_t capacity;                                 \
+    } retired;                                           \
+};
+
+/**
+ * @brief begin change of `sl.da` by writer, only one writer
+ * at the same time, change must not realloc items
+ * @param sl pointer to seqlock dynamic array
+ */
+#define da_seqlock_write_begin(type) DA_FUNC_NAME(seqlock_write_begin, type)
+#define DA_DECLARE_SEQLOCK_WRITE_BEGIN(type) \
+void da_seqlock_write_begin(type)(           \
+struct DA_SEQLOCK_STRUCT_NAME(type)* sl)
+#define DA_DEFINE_SEQLOCK_WRITE_BEGIN(type)                         \
+DA_DECLARE_SEQLOCK_WRITE_BEGIN(type) {                              \
+    unsigned seq = atomic_load_explicit(&sl->seq,                   \
+        memory_order_relaxed);                                      \
+    assert(seq % 2 == 0 && "Nested write");                         \
+    atomic_store_explicit(&sl->seq, seq + 1, memory_order_relaxed); \
+    atomic_thread_fence(memory_order_release);                      \
+}
+
+/**
+ * @brief end change of `sl.da` by writer
+ * @param sl pointer to seqlock dynamic array
+ */
+#define da_seqlock_write_end(type) DA_FUNC_NAME(seqlock_write_end, type)
+#define DA_DECLARE_SEQLOCK_WRITE_END(type) \
+void da_seqlock_write_end(type)(           \
+struct DA_SEQLOCK_STRUCT_NAME(type)* sl)
+#define DA_DEFINE_SEQLOCK_WRITE_END(type)                           \
+DA_DECLARE_SEQLOCK_WRITE_END(type) {                                \
+    unsigned seq = atomic_load_explicit(&sl->seq,                   \
+        memory_order_relaxed);                                      \
+    assert(seq % 2 == 1 && "Write not begun");                      \
+    atomic_store_explicit(&sl->view.items, sl->da.items,            \
+        memory_order_relaxed);                                      \
+    atomic_store_explicit(&sl->view.count, sl->da.count,            \
+        memory_order_release);                                      \
+    atomic_store_explicit(&sl->seq, seq + 1, memory_order_release); \
+}
+
+/**
+ * @brief wait end of write and begin optimistic read of `sl.da`,
+ * read data can be torn until da_seqlock_read_retry return 0
+ * @param sl pointer to seqlock dynamic array
+ * @return sequence for da_seqlock_read_retry
+ */
+#define da_seqlock_read_begin(type) DA_FUNC_NAME(seqlock_read_begin, type)
+#define DA_DECLARE_SEQLOCK_READ_BEGIN(type) \
+unsigned da_seqlock_read_begin(type)(       \
+const struct DA_SEQLOCK_STRUCT_NAME(type)* sl)
+#define DA_DEFINE_SEQLOCK_READ_BEGIN(type)       \
+DA_DECLARE_SEQLOCK_READ_BEGIN(type) {            \
+    unsigned seq;                                \
+    while ((seq = atomic_load_explicit(&sl->seq, \
+        memory_order_acquire)) % 2 == 1)         \
+        sched_yield();                           \
+    return seq;                                  \
+}
+
+/**
+ * @brief check read begun with sequence `seq` overlap change
+ * @param sl pointer to seqlock dynamic array
+ * @param seq sequence from da_seqlock_read_begin
+ * @return 1 if read must be repeated, else 0
+ */
+#define da_seqlock_read_retry(type) DA_FUNC_NAME(seqlock_read_retry, type)
+#define DA_DECLARE_SEQLOCK_READ_RETRY(type)    \
+int da_seqlock_read_retry(type)(               \
+const struct DA_SEQLOCK_STRUCT_NAME(type)* sl, \
+unsigned seq)
+#define DA_DEFINE_SEQLOCK_READ_RETRY(type)     \
+DA_DECLARE_SEQLOCK_READ_RETRY(type) {          \
+    atomic_thread_fence(memory_order_acquire); \
+    return atomic_load_explicit(&sl->seq,      \
+        memory_order_relaxed) != seq;          \
+}
+
+/**
+ * @brief items and count for optimistic read between
+ * da_seqlock_read_begin and da_seqlock_read_retry, buffer stay
+ * valid for `count` items, but items can be torn until retry
+ * @param sl pointer to seqlock dynamic array
+ * @param count pointer for count of readable items
+ * @return pointer to items
+ */
+#define da_seqlock_items(type) DA_FUNC_NAME(seqlock_items, type)
+#define DA_DECLARE_SEQLOCK_ITEMS(type)         \
+const type* da_seqlock_items(type)(            \
+const struct DA_SEQLOCK_STRUCT_NAME(type)* sl, \
+size_t* count)
+#define DA_DEFINE_SEQLOCK_ITEMS(type)              \
+DA_DECLARE_SEQLOCK_ITEMS(type) {                   \
+    *count = atomic_load_explicit(&sl->view.count, \
+        memory_order_acquire);                     \
+    return atomic_load_explicit(&sl->view.items,   \
+        memory_order_relaxed);                     \
+}
+
+/**
+ * @brief copy consistent snapshot of items to `out`, retry while
+ * writer change items, no atomic read-modify-write,
+ * need da_seqlock_items
+ * @param sl pointer to seqlock dynamic array
+ * @param out pointer to array for items
+ * @param max count of places in `out`
+ * @return count of items in snapshot, copied min(count, `max`)
+ */
+#define da_seqlock_copy(type) DA_FUNC_NAME(seqlock_copy, type)
+#define DA_DECLARE_SEQLOCK_COPY(type)          \
+size_t da_seqlock_copy(type)(                  \
+const struct DA_SEQLOCK_STRUCT_NAME(type)* sl, \
+type* out, size_t max)
+#define DA_DEFINE_SEQLOCK_COPY(type)                            \
+DA_DECLARE_SEQLOCK_COPY(type) {                                 \
+    size_t count;                                               \
+    unsigned seq;                                               \
+    do {                                                        \
+        seq = da_seqlock_read_begin(type)(sl);                  \
+        const type* items = da_seqlock_items(type)(sl, &count); \
+        if (count > 0 && max > 0)                               \
+            memcpy(out, items, (count < max ? count : max)      \
+                * sizeof(type));                                \
+    } while (da_seqlock_read_retry(type)(sl, seq));             \
+    return count;                                               \
+}
+
+/**
+ * @brief add `value` to end of `sl.da` under seqlock, growth
+ * copy items to new buffer and keep old one until free
+ * @param sl pointer to seqlock dynamic array
+ * @param value value for append
+ */
+#define da_seqlock_append(type) DA_FUNC_NAME(seqlock_append, type)
+#define DA_DECLARE_SEQLOCK_APPEND(type)  \
+void da_seqlock_append(type)(            \
+struct DA_SEQLOCK_STRUCT_NAME(type)* sl, \
+type value)
+#define DA_DEFINE_SEQLOCK_APPEND(type)                          \
+DA_DECLARE_SEQLOCK_APPEND(type) {                               \
+    struct DA_STRUCT_NAME(type)* da = &sl->da;                  \
+    type* grown = NULL;                                         \
+    size_t capacity = da->capacity;                             \
+    if (da->count >= capacity) {                                \
+        capacity += capacity == 0                               \
+            ? DA_DEFAULT_INIT_CAP : (capacity + 1) / 2;         \
+        grown = malloc(capacity * sizeof(type));                \
+        assert(grown != NULL && "Not memory");                  \
+        if (da->count > 0)                                      \
+            memcpy(grown, da->items, da->count * sizeof(type)); \
+        if (da->items != NULL) {                                \
+            DA_GROW(&sl->retired, sl->retired.count + 1);       \
+            sl->retired.items[sl->retired.count++] = da->items; \
+        }                                                       \
+    }                                                           \
+    da_seqlock_write_begin(type)(sl);                           \
+    if (grown != NULL) {                                        \
+        da->items = grown;                                      \
+        da->capacity = capacity;                                \
+    }                                                           \
+    da->items[da->count++] = value;                             \
+    da_seqlock_write_end(type)(sl);                             \
+}
+
+/**
+ * @brief destroy item at `index` and shift other items
+ * under seqlock
+ * @param sl pointer to seqlock dynamic array
+ * @param index valid index in range [0, `sl.da.count`)
+ */
+#define da_seqlock_remove(type) DA_FUNC_NAME(seqlock_remove, type)
+#define DA_DECLARE_SEQLOCK_REMOVE(type)  \
+void da_seqlock_remove(type)(            \
+struct DA_SEQLOCK_STRUCT_NAME(type)* sl, \
+size_t index)
+#define DA_DEFINE_SEQLOCK_REMOVE(type)                 \
+DA_DECLARE_SEQLOCK_REMOVE(type) {                      \
+    struct DA_STRUCT_NAME(type)* da = &sl->da;         \
+    assert(index < da->count && "Out of range");       \
+    da_seqlock_write_begin(type)(sl);                  \
+    if (da->dtor != NULL)                              \
+        da->dtor(&da->items[index]);                   \
+    memmove(&da->items[index], &da->items[index] + 1,  \
+        sizeof(*da->items) * (da->count - index - 1)); \
+    --(da->count);                                     \
+    da_seqlock_write_end(type)(sl);                    \
+}
+
+/**
+ * @brief destroy items, free current and kept buffers,
+ * call only when no readers
+ * @param sl pointer to seqlock dynamic array
+ */
+#define da_seqlock_free(type) DA_FUNC_NAME(seqlock_free, type)
+#define DA_DECLARE_SEQLOCK_FREE(type) \
+void da_seqlock_free(type)(           \
+struct DA_SEQLOCK_STRUCT_NAME(type)* sl)
+#define DA_DEFINE_SEQLOCK_FREE(type)           \
+DA_DECLARE_SEQLOCK_FREE(type) {                \
+    struct DA_STRUCT_NAME(type)* da = &sl->da; \
+    if (da->dtor != NULL)                      \
+        DA_FOREACH(type, item, da)             \
+            da->dtor(item);                    \
+    free(da->items);                           \
+    da->items = NULL;                          \
+    da->count = 0;                             \
+    da->capacity = 0;                          \
+    DA_FORLOOP(i, 0, sl->retired.count)        \
+        free(sl->retired.items[i]);            \
+    free(sl->retired.items);                   \
+    sl->retired.items = NULL;                  \
+    sl->retired.count = 0;                     \
+    sl->retired.capacity = 0;                  \
+    atomic_store(&sl->view.items, NULL);       \
+    atomic_store(&sl->view.count, 0);          \
+}
+
+/**
+ * Ring buffer for one producer and one consumer, capacity is
+ * power of two, `head` and `tail` on own cache lines with cached
+ * copy of other side, so push and pop mostly touch own line
+ */
+#define DA_RING_STRUCT_NAME(type) da_ring_struct_ ## type
+#define DA_DECLARE_RING(type, name) \
+typedef struct DA_RING_STRUCT_NAME(type) name;
+#define DA_DEFINE_RING(type, name)                           \
+DA_DECLARE_RING(type, name)                                  \
+struct DA_RING_STRUCT_NAME(type) {                           \
+    type*  items;                                            \
+    size_t mask;    /* capacity - 1 */                       \
+    void (*dtor)(type*);                                     \
+    _Alignas(DA_CACHE_LINE) _Atomic size_t head;  /* pop */  \
+    size_t tail_cache;                                       \
+    _Alignas(DA_CACHE_LINE) _Atomic size_t tail;  /* push */ \
+    size_t head_cache;                                       \
+};
+
+/**
+ * @brief allocate ring for `capacity` items rounded up to power
+ * of two and set destroy function `dtor`
+ * @param ring pointer to ring
+ * @param capacity minimal count of items in ring
+ * @param dtor destroy function for items or NULL
+ */
+#define da_ring_init(type) DA_FUNC_NAME(ring_init, type)
+#define DA_DECLARE_RING_INIT(type)      \
+void da_ring_init(type)(                \
+struct DA_RING_STRUCT_NAME(type)* ring, \
+size_t capacity, void (*dtor)(type*))
+#define DA_DEFINE_RING_INIT(type)                \
+DA_DECLARE_RING_INIT(type) {                     \
+    size_t size = 1;                             \
+    while (size < capacity) size <<= 1;          \
+    ring->items = malloc(size * sizeof(type));   \
+    assert(ring->items != NULL && "Not memory"); \
+    ring->mask = size - 1;                       \
+    ring->dtor = dtor;                           \
+    atomic_init(&ring->head, 0);                 \
+    atomic_init(&ring->tail, 0);                 \
+    ring->tail_cache = 0;                        \
+    ring->head_cache = 0;                        \
+}
+
+/**
+ * @brief add up to `count` values to ring by producer,
+ * copied by memcpy in at most two parts
+ * @param ring pointer to ring
+ * @param values pointer to array of values
+ * @param count count items in `values`
+ * @return count of pushed values, less than `count` if ring full
+ */
+#define da_ring_push_many(type) DA_FUNC_NAME(ring_push_many, type)
+#define DA_DECLARE_RING_PUSH_MANY(type) \
+size_t da_ring_push_many(type)(         \
+struct DA_RING_STRUCT_NAME(type)* ring, \
+const type* values, size_t count)
+#define DA_DEFINE_RING_PUSH_MANY(type)                                 \
+DA_DECLARE_RING_PUSH_MANY(type) {                                      \
+    size_t tail = atomic_load_explicit(&ring->tail,                    \
+        memory_order_relaxed);                                         \
+    size_t size = ring->mask + 1;                                      \
+    if (size - (tail - ring->head_cache) < count)                      \
+        ring->head_cache = atomic_load_explicit(&ring->head,           \
+            memory_order_acquire);                                     \
+    size_t free_places = size - (tail - ring->head_cache);             \
+    if (count > free_places) count = free_places;                      \
+    if (count == 0) return 0;                                          \
+    size_t first = tail & ring->mask;                                  \
+    size_t part = size - first < count ? size - first : count;         \
+    memcpy(ring->items + first, values, part * sizeof(type));          \
+    memcpy(ring->items, values + part, (count - part) * sizeof(type)); \
+    atomic_store_explicit(&ring->tail, tail + count,                   \
+        memory_order_release);                                         \
+    return count;                                                      \
+}
+
+/**
+ * @brief add `value` to ring by producer
+ * @param ring pointer to ring
+ * @param value value for push
+ * @return 1 if pushed, 0 if ring full
+ */
+#define da_ring_push(type) DA_FUNC_NAME(ring_push, type)
+#define DA_DECLARE_RING_PUSH(type)      \
+int da_ring_push(type)(                 \
+struct DA_RING_STRUCT_NAME(type)* ring, \
+type value)
+#define DA_DEFINE_RING_PUSH(type)                            \
+DA_DECLARE_RING_PUSH(type) {                                 \
+    size_t tail = atomic_load_explicit(&ring->tail,          \
+        memory_order_relaxed);                               \
+    if (tail - ring->head_cache > ring->mask) {              \
+        ring->head_cache = atomic_load_explicit(&ring->head, \
+            memory_order_acquire);                           \
+        if (tail - ring->head_cache > ring->mask) return 0;  \
+    }                                                        \
+    ring->items[tail & ring->mask] = value;                  \
+    atomic_store_explicit(&ring->tail, tail + 1,             \
+        memory_order_release);                               \
+    return 1;                                                \
+}
+
+/**
+ * @brief take up to `max` items from ring by consumer,
+ * copied by memcpy in at most two parts
+ * @param ring pointer to ring
+ * @param out pointer to array for items
+ * @param max count of places in `out`
+ * @return count of popped items
+ */
+#define da_ring_pop_many(type) DA_FUNC_NAME(ring_pop_many, type)
+#define DA_DECLARE_RING_POP_MANY(type)  \
+size_t da_ring_pop_many(type)(          \
+struct DA_RING_STRUCT_NAME(type)* ring, \
+type* out, size_t max)
+#define DA_DEFINE_RING_POP_MANY(type)                               \
+DA_DECLARE_RING_POP_MANY(type) {                                    \
+    size_t head = atomic_load_explicit(&ring->head,                 \
+        memory_order_relaxed);                                      \
+    if (ring->tail_cache - head < max)                              \
+        ring->tail_cache = atomic_load_explicit(&ring->tail,        \
+            memory_order_acquire);                                  \
+    size_t count = ring->tail_cache - head;                         \
+    if (count > max) count = max;                                   \
+    if (count == 0) return 0;                                       \
+    size_t size = ring->mask + 1;                                   \
+    size_t first = head & ring->mask;                               \
+    size_t part = size - first < count ? size - first : count;      \
+    memcpy(out, ring->items + first, part * sizeof(type));          \
+    memcpy(out + part, ring->items, (count - part) * sizeof(type)); \
+    atomic_store_explicit(&ring->head, head + count,                \
+        memory_order_release);                                      \
+    return count;                                                   \
+}
+
+/**
+ * @brief take item from ring by consumer
+ * @param ring pointer to ring
+ * @param out pointer for item
+ * @return 1 if popped, 0 if ring empty
+ */
+#define da_ring_pop(type) DA_FUNC_NAME(ring_pop, type)
+#define DA_DECLARE_RING_POP(type)       \
+int da_ring_pop(type)(                  \
+struct DA_RING_STRUCT_NAME(type)* ring, \
+type* out)
+#define DA_DEFINE_RING_POP(type)                             \
+DA_DECLARE_RING_POP(type) {                                  \
+    size_t head = atomic_load_explicit(&ring->head,          \
+        memory_order_relaxed);                               \
+    if (head == ring->tail_cache) {                          \
+        ring->tail_cache = atomic_load_explicit(&ring->tail, \
+            memory_order_acquire);                           \
+        if (head == ring->tail_cache) return 0;              \
+    }                                                        \
+    *out = ring->items[head & ring->mask];                   \
+    atomic_store_explicit(&ring->head, head + 1,             \
+        memory_order_release);                               \
+    return 1;                                                \
+}
+
+/**
+ * @brief destroy items left in ring and free memory,
+ * call only when no producer and consumer
+ * @param ring pointer to ring
+ */
+#define da_ring_free(type) DA_FUNC_NAME(ring_free, type)
+#define DA_DECLARE_RING_FREE(type) \
+void da_ring_free(type)(           \
+struct DA_RING_STRUCT_NAME(type)* ring)
+#define DA_DEFINE_RING_FREE(type)                                 \
+DA_DECLARE_RING_FREE(type) {                                      \
+    size_t tail = atomic_load(&ring->tail);                       \
+    if (ring->dtor != NULL)                                       \
+        for (size_t i = atomic_load(&ring->head); i != tail; ++i) \
+            ring->dtor(&ring->items[i & ring->mask]);             \
+    free(ring->items);                                            \
+    ring->items = NULL;                                           \
+    ring->mask = 0;                                               \
+    atomic_store(&ring->head, 0);                                 \
+    atomic_store(&ring->tail, 0);                                 \
+}
+
+/**
+ * Bounded queue for many producers and many consumers^5, every
+ * cell has sequence: equal position if cell free for push
+ * at position, position + 1 if value ready for pop
+ */
+#define DA_MPMC_STRUCT_NAME(type) da_mpmc_struct_ ## type
+#define DA_DECLARE_MPMC(type, name) \
+typedef struct DA_MPMC_STRUCT_NAME(type) name;
+#define DA_DEFINE_MPMC(type, name)                           \
+DA_DECLARE_MPMC(type, name)                                  \
+struct DA_FUNC_NAME(mpmc_cell, type) {                       \
+    _Atomic size_t seq;                                      \
+    type value;                                              \
+};                                                           \
+struct DA_MPMC_STRUCT_NAME(type) {                           \
+    struct DA_FUNC_NAME(mpmc_cell, type)* cells;             \
+    size_t mask;    /* capacity - 1 */                       \
+    void (*dtor)(type*);                                     \
+    _Alignas(DA_CACHE_LINE) _Atomic size_t tail;  /* push */ \
+    _Alignas(DA_CACHE_LINE) _Atomic size_t head;  /* pop */  \
+};
+
+/**
+ * @brief allocate queue for `capacity` items rounded up to power
+ * of two and set destroy function `dtor`
+ * @param q pointer to queue
+ * @param capacity minimal count of items in queue
+ * @param dtor destroy function for items or NULL
+ */
+#define da_mpmc_init(type) DA_FUNC_NAME(mpmc_init, type)
+#define DA_DECLARE_MPMC_INIT(type)   \
+void da_mpmc_init(type)(             \
+struct DA_MPMC_STRUCT_NAME(type)* q, \
+size_t capacity, void (*dtor)(type*))
+#define DA_DEFINE_MPMC_INIT(type)                \
+DA_DECLARE_MPMC_INIT(type) {                     \
+    size_t size = 2;                             \
+    while (size < capacity) size <<= 1;          \
+    q->cells = malloc(size * sizeof(*q->cells)); \
+    assert(q->cells != NULL && "Not memory");    \
+    DA_FORLOOP(i, 0, size)                       \
+        atomic_init(&q->cells[i].seq, i);        \
+    q->mask = size - 1;                          \
+    q->dtor = dtor;                              \
+    atomic_init(&q->tail, 0);                    \
+    atomic_init(&q->head, 0);                    \
+}
+
+/**
+ * @brief add `value` to queue from any thread without lock
+ * @param q pointer to queue
+ * @param value value for push
+ * @return 1 if pushed, 0 if queue full
+ */
+#define da_mpmc_try_push(type) DA_FUNC_NAME(mpmc_try_push, type)
+#define DA_DECLARE_MPMC_TRY_PUSH(type) \
+int da_mpmc_try_push(type)(            \
+struct DA_MPMC_STRUCT_NAME(type)* q,   \
+type value)
+#define DA_DEFINE_MPMC_TRY_PUSH(type)                                  \
+DA_DECLARE_MPMC_TRY_PUSH(type) {                                       \
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed); \
+    for (;;) {                                                         \
+        struct DA_FUNC_NAME(mpmc_cell, type)* cell =                   \
+            &q->cells[pos & q->mask];                                  \
+        intptr_t diff = (intptr_t)(atomic_load_explicit(&cell->seq,    \
+            memory_order_acquire) - pos);                              \
+        if (diff == 0) {                                               \
+            if (atomic_compare_exchange_weak_explicit(&q->tail,        \
+                &pos, pos + 1, memory_order_relaxed,                   \
+                memory_order_relaxed)) {                               \
+                cell->value = value;                                   \
+                atomic_store_explicit(&cell->seq, pos + 1,             \
+                    memory_order_release);                             \
+                return 1;                                              \
+            }                                                          \
+        } else if (diff < 0) {                                         \
+            return 0;                                                  \
+        } else {                                                       \
+            pos = atomic_load_explicit(&q->tail,                       \
+                memory_order_relaxed);                                 \
+        }                                                              \
+    }                                                                  \
+}
+
+/**
+ * @brief take item from queue from any thread without lock
+ * @param q pointer to queue
+ * @param out pointer for item
+ * @return 1 if popped, 0 if queue empty
+ */
+#define da_mpmc_try_pop(type) DA_FUNC_NAME(mpmc_try_pop, type)
+#define DA_DECLARE_MPMC_TRY_POP(type) \
+int da_mpmc_try_pop(type)(            \
+struct DA_MPMC_STRUCT_NAME(type)* q,  \
+type* out)
+#define DA_DEFINE_MPMC_TRY_POP(type)                                   \
+DA_DECLARE_MPMC_TRY_POP(type) {                                        \
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed); \
+    for (;;) {                                                         \
+        struct DA_FUNC_NAME(mpmc_cell, type)* cell =                   \
+            &q->cells[pos & q->mask];                                  \
+        intptr_t diff = (intptr_t)(atomic_load_explicit(&cell->seq,    \
+            memory_order_acquire) - (pos + 1));                        \
+        if (diff == 0) {                                               \
+            if (atomic_compare_exchange_weak_explicit(&q->head,        \
+                &pos, pos + 1, memory_order_relaxed,                   \
+                memory_order_relaxed)) {                               \
+                *out = cell->value;                                    \
+                atomic_store_explicit(&cell->seq, pos + q->mask + 1,   \
+                    memory_order_release);                             \
+                return 1;                                              \
+            }                                                          \
+        } else if (diff < 0) {                                         \
+            return 0;                                                  \
+        } else {                                                       \
+            pos = atomic_load_explicit(&q->head,                       \
+                memory_order_relaxed);                                 \
+        }                                                              \
+    }                                                                  \
+}
+
+/**
+ * @brief add up to `count` values to queue from any thread,
+ * reserve run of free cells by one CAS
+ * @param q pointer to queue
+ * @param values pointer to array of values
+ * @param count count items in `values`
+ * @return count of pushed values, 0 if queue full
+ */
+#define da_mpmc_try_push_many(type) DA_FUNC_NAME(mpmc_try_push_many, type)
+#define DA_DECLARE_MPMC_TRY_PUSH_MANY(type) \
+size_t da_mpmc_try_push_many(type)(         \
+struct DA_MPMC_STRUCT_NAME(type)* q,        \
+const type* values, size_t count)
+#define DA_DEFINE_MPMC_TRY_PUSH_MANY(type)                             \
+DA_DECLARE_MPMC_TRY_PUSH_MANY(type) {                                  \
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed); \
+    while (count > 0) {                                                \
+        size_t run = 0;                                                \
+        intptr_t diff = 0;                                             \
+        while (run < count) {                                          \
+            diff = (intptr_t)(atomic_load_explicit(                    \
+                &q->cells[(pos + run) & q->mask].seq,                  \
+                memory_order_acquire) - (pos + run));                  \
+            if (diff != 0) break;                                      \
+            ++run;                                                     \
+        }                                                              \
+        if (run == 0) {                                                \
+            if (diff < 0) return 0;                                    \
+            pos = atomic_load_explicit(&q->tail,                       \
+                memory_order_relaxed);                                 \
+        } else if (atomic_compare_exchange_weak_explicit(&q->tail,     \
+            &pos, pos + run, memory_order_relaxed,                     \
+            memory_order_relaxed)) {                                   \
+            DA_FORLOOP(i, 0, run) {                                    \
+                struct DA_FUNC_NAME(mpmc_cell, type)* cell =           \
+                    &q->cells[(pos + i) & q->mask];                    \
+                cell->value = values[i];                               \
+                atomic_store_explicit(&cell->seq, pos + i + 1,         \
+                    memory_order_release);                             \
+            }                                                          \
+            return run;                                                \
+        }                                                              \
+    }                                                                  \
+    return 0;                                                          \
+}
+
+/**
+ * @brief take up to `max` items from queue from any thread,
+ * reserve run of ready cells by one CAS
+ * @param q pointer to queue
+ * @param out pointer to array for items
+ * @param max count of places in `out`
+ * @return count of popped items, 0 if queue empty
+ */
+#define da_mpmc_try_pop_many(type) DA_FUNC_NAME(mpmc_try_pop_many, type)
+#define DA_DECLARE_MPMC_TRY_POP_MANY(type) \
+size_t da_mpmc_try_pop_many(type)(         \
+struct DA_MPMC_STRUCT_NAME(type)* q,       \
+type* out, size_t max)
+#define DA_DEFINE_MPMC_TRY_POP_MANY(type)                              \
+DA_DECLARE_MPMC_TRY_POP_MANY(type) {                                   \
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed); \
+    while (max > 0) {                                                  \
+        size_t run = 0;                                                \
+        intptr_t diff = 0;                                             \
+        while (run < max) {                                            \
+            diff = (intptr_t)(atomic_load_explicit(                    \
+                &q->cells[(pos + run) & q->mask].seq,                  \
+                memory_order_acquire) - (pos + run + 1));              \
+            if (diff != 0) break;                                      \
+            ++run;                                                     \
+        }                                                              \
+        if (run == 0) {                                                \
+            if (diff < 0) return 0;                                    \
+            pos = atomic_load_explicit(&q->head,                       \
+                memory_order_relaxed);                                 \
+        } else if (atomic_compare_exchange_weak_explicit(&q->head,     \
+            &pos, pos + run, memory_order_relaxed,                     \
+            memory_order_relaxed)) {                                   \
+            DA_FORLOOP(i, 0, run) {                                    \
+                struct DA_FUNC_NAME(mpmc_cell, type)* cell =           \
+                    &q->cells[(pos + i) & q->mask];                    \
+                out[i] = cell->value;                                  \
+                atomic_store_explicit(&cell->seq,                      \
+                    pos + i + q->mask + 1, memory_order_release);      \
+            }                                                          \
+            return run;                                                \
+        }                                                              \
+    }                                                                  \
+    return 0;                                                          \
+}
+
+/**
+ * @brief destroy items left in queue and free memory,
+ * call only when no producers and consumers
+ * @param q pointer to queue
+ */
+#define da_mpmc_free(type) DA_FUNC_NAME(mpmc_free, type)
+#define DA_DECLARE_MPMC_FREE(type) \
+void da_mpmc_free(type)(           \
+struct DA_MPMC_STRUCT_NAME(type)* q)
+#define DA_DEFINE_MPMC_FREE(type)                              \
+DA_DECLARE_MPMC_FREE(type) {                                   \
+    size_t tail = atomic_load(&q->tail);                       \
+    if (q->dtor != NULL)                                       \
+        for (size_t i = atomic_load(&q->head); i != tail; ++i) \
+            q->dtor(&q->cells[i & q->mask].value);             \
+    free(q->cells);                                            \
+    q->cells = NULL;                                           \
+    q->mask = 0;                                               \
+    atomic_store(&q->tail, 0);                                 \
+    atomic_store(&q->head, 0);                                 \
+}
+
+#endif // DA_ENABLE_THREADS
+
 #endif // DYNAMIC_ARRAY_H
\ No newline at end of file
@@ -0,0 +1,59 @@
+/* Bit array against byte per bit model: bulk appends, search, word ops */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_BITARRAY(bits)
+
+#define COUNT 10000
+
+static uint8_t model_a[COUNT], model_b[COUNT];
+
+int main(void) {
+    /* any nonzero byte is set bit */
+    for (size_t i = 0; i < COUNT; ++i) {
+        model_a[i] = test_random() % 7 == 0;
+        model_b[i] = test_random() % 3 == 0 ? 5 : 0;
+    }
+    bits a = {0}, b = {0};
+    /* odd head, so bulk append starts inside word */
+    for (size_t i = 0; i < 37; ++i)
+        da_bits_append(bits)(&a, model_a[i]);
+    da_bits_append_many(bits)(&a, model_a + 37, COUNT - 37);
+    da_bits_append_many(bits)(&b, model_b, COUNT);
+    size_t set = 0;
+    for (size_t i = 0; i < COUNT; ++i) {
+        set += model_a[i];
+        CHECK(da_bits_get(bits)(&a, i) == model_a[i]);
+        CHECK(da_bits_get(bits)(&b, i) == (model_b[i] != 0));
+    }
+    CHECK(da_bits_popcount(bits)(&a) == set);
+    for (size_t from = 0; from < COUNT; from += 13) {
+        size_t expected = from;
+        while (expected < COUNT && !model_a[expected]) ++expected;
+        CHECK(da_bits_find_first_set(bits)(&a, from) == expected);
+    }
+
+    /* long run of zeros, not found is count */
+    bits z = {0};
+    for (size_t i = 0; i < 5000; ++i)
+        da_bits_append(bits)(&z, 0);
+    da_bits_set(bits)(&z, 4999, 1);
+    CHECK(da_bits_find_first_set(bits)(&z, 0) == 4999);
+    CHECK(da_bits_find_first_set(bits)(&z, 5000) == 5000);
+    da_bits_set(bits)(&z, 4999, 0);
+    CHECK(da_bits_find_first_set(bits)(&z, 3) == 5000);
+
+    da_bits_and(bits)(&a, &b);
+    for (size_t i = 0; i < COUNT; ++i)
+        CHECK(da_bits_get(bits)(&a, i) == (model_a[i] && model_b[i]));
+    /* (a & b) | b == b, and b ^ b has no set bits */
+    da_bits_or(bits)(&a, &b);
+    da_bits_xor(bits)(&a, &b);
+    CHECK(da_bits_popcount(bits)(&a) == 0);
+    da_bits_free(bits)(&a);
+    da_bits_free(bits)(&b);
+    da_bits_free(bits)(&z);
+    puts("bitarray: ok");
+    return 0;
+}
@@ -0,0 +1,31 @@
+/*
+Helpers of tests: CHECK exit with message on false condition,
+test_random is xorshift generator for repeatable random input.
+*/
+
+#ifndef DA_TESTS_CHECK_H
+#define DA_TESTS_CHECK_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#define CHECK(cond)                                          \
+do {                                                         \
+    if (!(cond)) {                                           \
+        fprintf(stderr, "%s:%d: check failed: %s\n",         \
+            __FILE__, __LINE__, #cond);                      \
+        exit(1);                                             \
+    }                                                        \
+} while (0)
+
+static uint64_t test_state = 88172645463325252ull;
+
+static inline uint64_t test_random(void) {
+    test_state ^= test_state << 13;
+    test_state ^= test_state >> 7;
+    test_state ^= test_state << 17;
+    return test_state;
+}
+
+#endif // DA_TESTS_CHECK_H
@@ -0,0 +1,64 @@
+/* Concurrent append from many threads: every value once at its index */
+
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_CONCURRENT_STRUCT(long, concurrent_t)
+DA_DEFINE_CONCURRENT_AT(long)
+DA_DEFINE_CONCURRENT_APPEND(long)
+DA_DEFINE_CONCURRENT_FREE(long)
+
+#define THREADS 6
+#define PER_THREAD 20000
+
+static concurrent_t shared;
+static size_t indices[THREADS][PER_THREAD];
+static size_t destroyed;
+static void count_dtor(long* item) { (void)item; ++destroyed; }
+
+static void* producer(void* arg) {
+    size_t id = (size_t)arg;
+    for (size_t i = 0; i < PER_THREAD; ++i)
+        indices[id][i] = da_concurrent_append(long)(
+            &shared, (long)(id * PER_THREAD + i));
+    return NULL;
+}
+
+int main(void) {
+    const size_t total = THREADS * PER_THREAD;
+    for (int round = 0; round < 3; ++round) {
+        shared.dtor = count_dtor;
+        pthread_t threads[THREADS];
+        for (size_t t = 0; t < THREADS; ++t)
+            CHECK(pthread_create(&threads[t], NULL,
+                producer, (void*)t) == 0);
+        for (size_t t = 0; t < THREADS; ++t)
+            pthread_join(threads[t], NULL);
+        CHECK(shared.count == total);
+        /* returned index holds value, values of one thread in order */
+        char* seen = calloc(total, 1);
+        CHECK(seen != NULL);
+        for (size_t t = 0; t < THREADS; ++t)
+            for (size_t i = 0; i < PER_THREAD; ++i) {
+                size_t index = indices[t][i];
+                CHECK(index < total && !seen[index]);
+                CHECK(*da_concurrent_at(long)(&shared, index)
+                    == (long)(t * PER_THREAD + i));
+                CHECK(i == 0 || indices[t][i - 1] < index);
+                seen[index] = 1;
+            }
+        free(seen);
+        /* foreach of segmented array visit every index in order */
+        size_t k = 0;
+        DA_SEGMENTED_FOREACH(long, item, &shared)
+            CHECK(item == da_concurrent_at(long)(&shared, k++));
+        CHECK(k == total);
+        destroyed = 0;
+        da_concurrent_free(long)(&shared);
+        CHECK(destroyed == total);
+        CHECK(shared.segments[0] == NULL && shared.count == 0);
+    }
+    puts("concurrent: ok");
+    return 0;
+}
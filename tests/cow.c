@@ -0,0 +1,63 @@
+/* Copy-on-write array: snapshots keep values after changes of source */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_COW(int, cow_t)
+DA_DEFINE_COW_AT(int)
+DA_DEFINE_COW_SET(int)
+DA_DEFINE_COW_APPEND(int)
+DA_DEFINE_COW_SNAPSHOT(int)
+DA_DEFINE_COW_FREE(int)
+
+#define MAX_ITEMS 5000
+#define MAX_SNAPSHOTS 8
+
+struct expected {
+    int items[MAX_ITEMS];
+    size_t count;
+};
+
+static struct expected current, saved[MAX_SNAPSHOTS];
+
+static void check_equal(const cow_t* cow, const struct expected* ref) {
+    CHECK(cow->count == ref->count);
+    for (size_t i = 0; i < ref->count; ++i)
+        CHECK(*da_cow_at(int)(cow, i) == ref->items[i]);
+}
+
+int main(void) {
+    cow_t cow = {0}, snapshots[MAX_SNAPSHOTS];
+    size_t nsnapshots = 0;
+    for (int step = 0; step < 20000; ++step) {
+        uint64_t r = test_random();
+        int op = (int)(r % 10);
+        if (op < 5 && current.count < MAX_ITEMS) {
+            da_cow_append(int)(&cow, step);
+            current.items[current.count++] = step;
+        } else if (op < 9 && current.count > 0) {
+            size_t index = (r >> 8) % current.count;
+            da_cow_set(int)(&cow, index, -step);
+            current.items[index] = -step;
+        } else if (nsnapshots < MAX_SNAPSHOTS) {
+            snapshots[nsnapshots] = da_cow_snapshot(int)(&cow);
+            saved[nsnapshots++] = current;
+        } else {
+            /* release random snapshot, shared chunks stay alive */
+            size_t k = (r >> 8) % nsnapshots;
+            check_equal(&snapshots[k], &saved[k]);
+            da_cow_free(int)(&snapshots[k]);
+            snapshots[k] = snapshots[--nsnapshots];
+            saved[k] = saved[nsnapshots];
+        }
+    }
+    check_equal(&cow, &current);
+    for (size_t k = 0; k < nsnapshots; ++k) {
+        check_equal(&snapshots[k], &saved[k]);
+        da_cow_free(int)(&snapshots[k]);
+    }
+    da_cow_free(int)(&cow);
+    CHECK(cow.count == 0);
+    puts("cow: ok");
+    return 0;
+}
@@ -0,0 +1,80 @@
+/* Deque against plain array model: random pushes and pops at both ends */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_DEQUE(int, deque_t)
+DA_DEFINE_DEQUE_AT(int)
+DA_DEFINE_DEQUE_PUSH_BACK(int)
+DA_DEFINE_DEQUE_PUSH_FRONT(int)
+DA_DEFINE_DEQUE_POP_BACK(int)
+DA_DEFINE_DEQUE_POP_FRONT(int)
+DA_DEFINE_DEQUE_FREE(int)
+
+#define STEPS 60000
+
+/* model keeps items in [head, head + count) of big array */
+static int model[2 * STEPS];
+static size_t destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+/* foreach visit items of model in order, also when ring wraps */
+static void check_foreach(const deque_t* dq, size_t head, size_t count) {
+    size_t k = 0;
+    DA_DEQUE_FOREACH(int, item, dq) {
+        CHECK(k < count && *item == model[head + k]);
+        ++k;
+    }
+    CHECK(k == count);
+    /* break in first span leaves second span too */
+    k = 0;
+    DA_DEQUE_FOREACH(int, item, dq) {
+        (void)item;
+        ++k;
+        break;
+    }
+    CHECK(k == (count > 0));
+}
+
+int main(void) {
+    deque_t dq = {0};
+    dq.dtor = count_dtor;
+    size_t head = STEPS, count = 0;
+    for (int i = 0; i < STEPS; ++i) {
+        /* more pushes than pops, front pushes wrap the ring */
+        switch (test_random() % 5) {
+        case 0:
+            da_deque_push_back(int)(&dq, i);
+            model[head + count++] = i;
+            break;
+        case 1: case 4:
+            da_deque_push_front(int)(&dq, i);
+            model[--head] = i;
+            ++count;
+            break;
+        case 2:
+            if (count > 0)
+                CHECK(da_deque_pop_back(int)(&dq)
+                    == model[head + --count]);
+            break;
+        case 3:
+            if (count > 0) {
+                CHECK(da_deque_pop_front(int)(&dq) == model[head++]);
+                --count;
+            }
+            break;
+        }
+        CHECK(dq.count == count);
+        if (count > 0) {
+            CHECK(*da_deque_at(int)(&dq, 0) == model[head]);
+            CHECK(*da_deque_at(int)(&dq, count - 1)
+                == model[head + count - 1]);
+        }
+        if (i % 4096 == 0) check_foreach(&dq, head, count);
+    }
+    check_foreach(&dq, head, count);
+    da_deque_free(int)(&dq);
+    CHECK(destroyed == count && dq.count == 0);
+    puts("deque: ok");
+    return 0;
+}
@@ -0,0 +1,69 @@
+/* Epoch array: readers see valid prefix while writer grows, reclaim */
+
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_EPOCH_STRUCT(long, epoch_t)
+DA_DEFINE_EPOCH_INIT(long)
+DA_DEFINE_READ_BEGIN(long)
+DA_DEFINE_READ_END(long)
+DA_DEFINE_EPOCH_RECLAIM(long)
+DA_DEFINE_EPOCH_APPEND(long)
+DA_DEFINE_EPOCH_FREE(long)
+
+#define READERS 4
+#define COUNT 300000
+
+static epoch_t shared;
+static _Atomic int done;
+
+/* item `i` is always `i`, so any torn or freed buffer is visible */
+static void* reader(void* arg) {
+    size_t id = (size_t)arg;
+    size_t last = 0;
+    while (!atomic_load(&done)) {
+        size_t count;
+        const long* items = da_read_begin(long)(&shared, id, &count);
+        CHECK(count >= last);
+        for (size_t i = 0; i < count; ++i)
+            CHECK(items[i] == (long)i);
+        da_read_end(long)(&shared, id);
+        last = count;
+    }
+    return NULL;
+}
+
+int main(void) {
+    /* open section keeps old buffers until it ends */
+    epoch_t da;
+    da_epoch_init(long)(&da, 1, NULL);
+    da_epoch_append(long)(&da, 0);
+    size_t count;
+    const long* held = da_read_begin(long)(&da, 0, &count);
+    for (long i = 1; i < 1000; ++i)
+        da_epoch_append(long)(&da, i);
+    CHECK(count == 1 && held[0] == 0 && da.retired.count > 0);
+    da_read_end(long)(&da, 0);
+    /* appends without growth reclaim too */
+    size_t capacity = da.capacity;
+    for (long i = 0; i < DA_EPOCH_RECLAIM_PERIOD; ++i)
+        da_epoch_append(long)(&da, 1000 + i);
+    CHECK(da.retired.count == 0 && da.capacity == capacity);
+    da_epoch_free(long)(&da);
+
+    da_epoch_init(long)(&shared, READERS, NULL);
+    pthread_t threads[READERS];
+    for (size_t t = 0; t < READERS; ++t)
+        CHECK(pthread_create(&threads[t], NULL, reader, (void*)t) == 0);
+    for (long i = 0; i < COUNT; ++i)
+        da_epoch_append(long)(&shared, i);
+    atomic_store(&done, 1);
+    for (size_t t = 0; t < READERS; ++t)
+        pthread_join(threads[t], NULL);
+    da_epoch_reclaim(long)(&shared);
+    CHECK(shared.retired.count == 0 && shared.count == COUNT);
+    da_epoch_free(long)(&shared);
+    puts("epoch: ok");
+    return 0;
+}
@@ -0,0 +1,137 @@
+/* Find, count and contains against plain loop, every kernel the CPU has */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+typedef signed char schar;
+typedef const char* cstr;
+DA_DEFINE_ALL(schar, schars_t)
+DA_DEFINE_FIND(schar)
+DA_DEFINE_COUNT(schar)
+DA_DEFINE_CONTAINS(schar)
+DA_DEFINE_ALL(short, shorts_t)
+DA_DEFINE_FIND(short)
+DA_DEFINE_COUNT(short)
+DA_DEFINE_CONTAINS(short)
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_FIND(int)
+DA_DEFINE_COUNT(int)
+DA_DEFINE_CONTAINS(int)
+DA_DEFINE_ALL(long, longs_t)
+DA_DEFINE_FIND(long)
+DA_DEFINE_COUNT(long)
+DA_DEFINE_CONTAINS(long)
+DA_DEFINE_ALL(double, doubles_t)
+DA_DEFINE_FIND(double)
+DA_DEFINE_COUNT(double)
+DA_DEFINE_CONTAINS(double)
+DA_DEFINE_ALL(cstr, cstrs_t)
+DA_DEFINE_FIND(cstr)
+DA_DEFINE_COUNT(cstr)
+
+/* compare public functions of `type` with loop for values [-1, 9] */
+#define CHECK_FUNCTIONS(type, da)                                   \
+for (int v = -1; v <= 9; ++v) {                                     \
+    size_t first = (da)->count, found = 0;                          \
+    for (size_t i = 0; i < (da)->count; ++i)                        \
+        if ((da)->items[i] == (type)v) {                            \
+            if (first == (da)->count) first = i;                    \
+            ++found;                                                \
+        }                                                           \
+    CHECK(da_find(type)(da, (type)v) == first);                     \
+    CHECK(da_count(type)(da, (type)v) == found);                    \
+    CHECK(!da_contains(type)(da, (type)v) == (found == 0));         \
+}
+
+#ifdef DA_X86_SIMD
+/* compare kernel of `bits` and `isa` with loop, items differ from
+   needle only in high byte to catch wrong lane width */
+#define CHECK_KERNEL(bits, isa)                                     \
+for (size_t count = 0; count < 300; ++count) {                      \
+    uint##bits##_t items[300];                                      \
+    const uint##bits##_t one = (uint##bits##_t)0x0101010101010101u; \
+    const uint##bits##_t high = (uint##bits##_t)                    \
+        ((uint##bits##_t)1 << (bits - 8));                          \
+    for (size_t i = 0; i < count; ++i)                              \
+        items[i] = (uint##bits##_t)(test_random() % 7 * one         \
+            ^ (i == count / 2 ? high : 0));                         \
+    for (unsigned v = 0; v < 8; ++v) {                              \
+        uint##bits##_t value = (uint##bits##_t)(v * one);           \
+        size_t first = count, found = 0;                            \
+        for (size_t i = 0; i < count; ++i)                          \
+            if (items[i] == value) {                                \
+                if (first == count) first = i;                      \
+                ++found;                                            \
+            }                                                       \
+        CHECK(da_impl_find_##bits##_##isa(items, count, value)      \
+            == first);                                              \
+        CHECK(da_impl_count_##bits##_##isa(items, count, value)     \
+            == found);                                              \
+    }                                                               \
+}
+#endif
+
+int main(void) {
+#ifdef DA_X86_SIMD
+    int level = da_impl_simd_level();
+    if (level >= DA_IMPL_SIMD_SSE2) {
+        CHECK_KERNEL(8, sse2)
+        CHECK_KERNEL(16, sse2)
+        CHECK_KERNEL(32, sse2)
+        CHECK_KERNEL(64, sse2)
+    }
+    if (level >= DA_IMPL_SIMD_AVX2) {
+        CHECK_KERNEL(8, avx2)
+        CHECK_KERNEL(16, avx2)
+        CHECK_KERNEL(32, avx2)
+        CHECK_KERNEL(64, avx2)
+    }
+    if (level >= DA_IMPL_SIMD_AVX512F) {
+        CHECK_KERNEL(32, avx512)
+        CHECK_KERNEL(64, avx512)
+    }
+    if (level >= DA_IMPL_SIMD_AVX512BW) {
+        CHECK_KERNEL(8, avx512)
+        CHECK_KERNEL(16, avx512)
+    }
+#endif
+    for (size_t count = 0; count < 200; ++count) {
+        schars_t chars = {0};
+        shorts_t shorts = {0};
+        ints_t ints = {0};
+        longs_t longs = {0};
+        doubles_t doubles = {0};
+        for (size_t i = 0; i < count; ++i) {
+            int item = (int)(test_random() % 9);
+            da_append(schar)(&chars, (schar)item);
+            da_append(short)(&shorts, (short)item);
+            da_append(int)(&ints, item);
+            da_append(long)(&longs, item);
+            da_append(double)(&doubles, item);
+        }
+        CHECK_FUNCTIONS(schar, &chars)
+        CHECK_FUNCTIONS(short, &shorts)
+        CHECK_FUNCTIONS(int, &ints)
+        CHECK_FUNCTIONS(long, &longs)
+        CHECK_FUNCTIONS(double, &doubles)
+        da_free(schar)(&chars);
+        da_free(short)(&shorts);
+        da_free(int)(&ints);
+        da_free(long)(&longs);
+        da_free(double)(&doubles);
+    }
+    /* floating point compared by value, not by bits */
+    doubles_t zeros = {0};
+    da_append(double)(&zeros, -0.0);
+    CHECK(da_find(double)(&zeros, 0.0) == 0);
+    da_free(double)(&zeros);
+    cstrs_t strings = {0};
+    static const char a[] = "a", b[] = "b", c[] = "c";
+    const cstr words[] = {a, b, c, b};
+    da_append_many(cstr)(&strings, words, 4);
+    CHECK(da_find(cstr)(&strings, words[3]) == 1);
+    CHECK(da_count(cstr)(&strings, words[1]) == 2);
+    da_free(cstr)(&strings);
+    puts("find: ok");
+    return 0;
+}
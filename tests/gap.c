@@ -0,0 +1,64 @@
+/* Gap buffer against plain array model: edits at random cursors */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_GAP_BUFFER(int, gap_t)
+DA_DEFINE_GAP_AT(int)
+DA_DEFINE_GAP_MOVE(int)
+DA_DEFINE_GAP_INSERT(int)
+DA_DEFINE_GAP_DELETE(int)
+DA_DEFINE_GAP_SPANS(int)
+DA_DEFINE_GAP_FREE(int)
+
+#define STEPS 30000
+
+static int model[STEPS];
+static size_t destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+/* spans are model split at cursor */
+static void check_spans(const gap_t* gb, size_t count) {
+    const int *first, *second;
+    size_t first_count, second_count;
+    da_gap_spans(int)(gb, &first, &first_count, &second, &second_count);
+    CHECK(first_count == gb->gap && first_count + second_count == count);
+    CHECK(memcmp(first, model, first_count * sizeof(int)) == 0);
+    CHECK(memcmp(second, model + first_count, second_count * sizeof(int))
+        == 0);
+}
+
+int main(void) {
+    gap_t gb = {0};
+    gb.dtor = count_dtor;
+    size_t count = 0, cursor = 0, deleted = 0;
+    for (int i = 0; i < STEPS; ++i) {
+        unsigned op = test_random() % 6;
+        if (op < 3) {
+            da_gap_insert(int)(&gb, i);
+            memmove(model + cursor + 1, model + cursor,
+                (count - cursor) * sizeof(int));
+            model[cursor++] = i;
+            ++count;
+        } else if (op < 5) {
+            cursor = test_random() % (count + 1);
+            da_gap_move(int)(&gb, cursor);
+        } else {
+            size_t n = count - cursor < 3 ? count - cursor : 3;
+            da_gap_delete(int)(&gb, n);
+            memmove(model + cursor, model + cursor + n,
+                (count - cursor - n) * sizeof(int));
+            count -= n;
+            deleted += n;
+        }
+        CHECK(gb.count == count && gb.gap == cursor);
+        if (i % 1024 == 0) check_spans(&gb, count);
+    }
+    for (size_t i = 0; i < count; ++i)
+        CHECK(*da_gap_at(int)(&gb, i) == model[i]);
+    check_spans(&gb, count);
+    da_gap_free(int)(&gb);
+    CHECK(destroyed == deleted + count);
+    puts("gap: ok");
+    return 0;
+}
@@ -0,0 +1,71 @@
+/* Random insert/erase on hive: stable pointers, skipfield iteration */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_HIVE(int, hive_t)
+DA_DEFINE_HIVE_INSERT(int)
+DA_DEFINE_HIVE_ERASE(int)
+DA_DEFINE_HIVE_FREE(int)
+
+#define KEYS 100000
+
+static int* pointers[KEYS];
+static char alive[KEYS];
+static size_t destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+/* foreach visit every live key once at its pointer, skip erased */
+static void check_iteration(const hive_t* hive, size_t live) {
+    static char seen[KEYS];
+    memset(seen, 0, sizeof(seen));
+    size_t visited = 0;
+    DA_HIVE_FOREACH(int, item, hive) {
+        CHECK(*item >= 0 && *item < KEYS);
+        CHECK(alive[*item] && !seen[*item] && pointers[*item] == item);
+        seen[*item] = 1;
+        ++visited;
+    }
+    CHECK(visited == live && hive->count == live);
+}
+
+int main(void) {
+    hive_t hive = {0};
+    hive.dtor = count_dtor;
+    size_t live = 0, erased = 0;
+    for (int round = 0; round < 4; ++round) {
+        for (int key = 0; key < KEYS; ++key)
+            if (!alive[key] && test_random() % 4 != 0) {
+                pointers[key] = da_hive_insert(int)(&hive, key);
+                alive[key] = 1;
+                ++live;
+            }
+        check_iteration(&hive, live);
+        /* erase runs of neighbours and single items */
+        for (int key = 0; key < KEYS; ++key)
+            if (alive[key] && test_random() % 3 == 0) {
+                CHECK(*pointers[key] == key);
+                da_hive_erase(int)(&hive, pointers[key]);
+                alive[key] = 0;
+                --live;
+                ++erased;
+            }
+        check_iteration(&hive, live);
+    }
+    for (int key = 0; key < KEYS; ++key)
+        if (alive[key]) {
+            da_hive_erase(int)(&hive, pointers[key]);
+            alive[key] = 0;
+            ++erased;
+        }
+    check_iteration(&hive, 0);
+    for (int key = 0; key < 1000; ++key) {
+        pointers[key] = da_hive_insert(int)(&hive, key);
+        alive[key] = 1;
+    }
+    check_iteration(&hive, 1000);
+    da_hive_free(int)(&hive);
+    CHECK(destroyed == erased + 1000);
+    puts("hive: ok");
+    return 0;
+}
@@ -0,0 +1,55 @@
+/* Map and filter with one reservation of destination */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_ALL(double, doubles_t)
+DA_DEFINE_MAP(int, double)
+DA_DEFINE_FILTER(int)
+
+static double half(const int* item, void* ctx) {
+    (void)ctx;
+    return *item / 2.0;
+}
+
+static int is_odd(const int* item, void* ctx) {
+    ++*(int*)ctx;
+    return *item & 1;
+}
+
+static int destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+int main(void) {
+    ints_t ints = {0};
+    for (int i = 0; i < 1000; ++i) da_append(int)(&ints, i);
+
+    /* map append to end of destination */
+    doubles_t halves = {0};
+    da_append(double)(&halves, -1);
+    da_map(int, double)(&halves, &ints, half, NULL);
+    CHECK(halves.count == 1001);
+    CHECK(halves.items[0] == -1 && halves.items[1000] == 499.5);
+
+    /* filter reserve exactly count of kept items */
+    ints_t odd = {0};
+    int calls = 0;
+    da_filter(int)(&odd, &ints, is_odd, &calls);
+    CHECK(calls == 1000);
+    CHECK(odd.count == 500 && odd.capacity == 500);
+    for (size_t i = 0; i < odd.count; ++i)
+        CHECK(odd.items[i] == 2 * (int)i + 1);
+
+    /* filter in place destroy dropped items */
+    ints.dtor = count_dtor;
+    da_filter(int)(&ints, &ints, is_odd, &calls);
+    CHECK(ints.count == 500 && ints.items[499] == 999);
+    CHECK(destroyed == 500);
+
+    da_free(int)(&ints);
+    da_free(int)(&odd);
+    da_free(double)(&halves);
+    puts("map_filter: ok");
+    return 0;
+}
@@ -0,0 +1,88 @@
+/* Bounded MPMC queue: no lost or doubled items under contention */
+
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_MPMC(long, queue_t)
+DA_DEFINE_MPMC_INIT(long)
+DA_DEFINE_MPMC_TRY_PUSH(long)
+DA_DEFINE_MPMC_TRY_POP(long)
+DA_DEFINE_MPMC_TRY_PUSH_MANY(long)
+DA_DEFINE_MPMC_TRY_POP_MANY(long)
+DA_DEFINE_MPMC_FREE(long)
+
+#define PRODUCERS 3
+#define CONSUMERS 3
+#define ITEMS 50000L
+
+static queue_t queue;
+static _Atomic long long sum;
+static _Atomic long popped;
+
+/* odd steps push one value, even steps push batch of 7 */
+static void* producer(void* ptr) {
+    long id = (long)(intptr_t)ptr, done = 0, values[7];
+    while (done < ITEMS) {
+        size_t n;
+        if (done % 2) {
+            n = (size_t)da_mpmc_try_push(long)(&queue, id * ITEMS + done);
+        } else {
+            size_t count = 0;
+            while (count < 7 && done + (long)count < ITEMS) {
+                values[count] = id * ITEMS + done + (long)count;
+                ++count;
+            }
+            n = da_mpmc_try_push_many(long)(&queue, values, count);
+        }
+        if (n == 0) sched_yield();
+        done += (long)n;
+    }
+    return NULL;
+}
+
+static void* consumer(void* ptr) {
+    (void)ptr;
+    long values[5];
+    for (int step = 0;
+        atomic_load(&popped) < PRODUCERS * ITEMS; ++step) {
+        size_t n = step % 2
+            ? (size_t)da_mpmc_try_pop(long)(&queue, values)
+            : da_mpmc_try_pop_many(long)(&queue, values, 5);
+        if (n == 0) {
+            sched_yield();
+            continue;
+        }
+        for (size_t i = 0; i < n; ++i) atomic_fetch_add(&sum, values[i]);
+        atomic_fetch_add(&popped, (long)n);
+    }
+    return NULL;
+}
+
+int main(void) {
+    da_mpmc_init(long)(&queue, 64, NULL);
+    pthread_t threads[PRODUCERS + CONSUMERS];
+    for (long i = 0; i < PRODUCERS; ++i)
+        CHECK(pthread_create(&threads[i], NULL,
+            producer, (void*)(intptr_t)i) == 0);
+    for (long i = 0; i < CONSUMERS; ++i)
+        CHECK(pthread_create(&threads[PRODUCERS + i], NULL,
+            consumer, NULL) == 0);
+    for (int i = 0; i < PRODUCERS + CONSUMERS; ++i)
+        pthread_join(threads[i], NULL);
+    long long total = PRODUCERS * ITEMS;
+    CHECK(atomic_load(&popped) == total);
+    CHECK(atomic_load(&sum) == total * (total - 1) / 2);
+
+    /* full and empty queue on one thread */
+    long value, values[100];
+    CHECK(!da_mpmc_try_pop(long)(&queue, &value));
+    for (int i = 0; i < 100; ++i) values[i] = i;
+    CHECK(da_mpmc_try_push_many(long)(&queue, values, 100) == 64);
+    CHECK(!da_mpmc_try_push(long)(&queue, 1));
+    CHECK(da_mpmc_try_pop_many(long)(&queue, values, 100) == 64);
+    for (int i = 0; i < 64; ++i) CHECK(values[i] == i);
+    da_mpmc_free(long)(&queue);
+    puts("mpmc: ok");
+    return 0;
+}
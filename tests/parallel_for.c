@@ -0,0 +1,54 @@
+/* Parallel for visits every item once, with and without aligned lines */
+
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include "check.h"
+
+/* size of 3 bytes does not divide cache line, no aligned chunks */
+typedef struct { char bytes[3]; } triple;
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_PARALLEL_FOR(int)
+DA_DEFINE_ALL(triple, triples_t)
+DA_DEFINE_PARALLEL_FOR(triple)
+
+/* uneven cost of items, so workers steal from each other */
+static void increment(int* item, void* ctx) {
+    if (++*item % 512 == 0)
+        for (volatile int spin = 0; spin < 2000; ++spin) {}
+    (void)ctx;
+}
+
+static void increment_triple(triple* item, void* ctx) {
+    ++item->bytes[0];
+    ++*(_Atomic size_t*)ctx;
+}
+
+int main(void) {
+    da_pool* pool = da_pool_create(4);
+    CHECK(pool != NULL);
+    for (size_t round = 0; round < 50; ++round) {
+        size_t count = round * round * 37 + round;
+        ints_t ints = {0};
+        triples_t triples = {0};
+        triple zero = {{0}};
+        for (size_t i = 0; i < count; ++i) {
+            da_append(int)(&ints, (int)i);
+            da_append(triple)(&triples, zero);
+        }
+        da_parallel_for(int)(&ints, increment, NULL, pool);
+        da_parallel_for(int)(&ints, increment, NULL, NULL);
+        for (size_t i = 0; i < count; ++i)
+            CHECK(ints.items[i] == (int)i + 2);
+        _Atomic size_t calls = 0;
+        da_parallel_for(triple)(&triples, increment_triple, &calls, pool);
+        CHECK(calls == count);
+        for (size_t i = 0; i < count; ++i)
+            CHECK(triples.items[i].bytes[0] == 1);
+        da_free(int)(&ints);
+        da_free(triple)(&triples);
+    }
+    da_pool_destroy(pool);
+    da_pool_destroy(NULL);
+    puts("parallel_for: ok");
+    return 0;
+}
@@ -0,0 +1,48 @@
+/* Prefix sums on pool against serial loop, in place and to other da */
+
+#define DA_ENABLE_THREADS
+#define DA_PARALLEL_SCAN_THRESHOLD 100
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_SCAN(int)
+DA_DEFINE_PARALLEL_SCAN(int)
+DA_DEFINE_ALL(long, longs_t)
+DA_DEFINE_SCAN(long)
+DA_DEFINE_PARALLEL_SCAN(long)
+
+/* check scans of `type` for every count, pool and mode */
+#define CHECK_SCANS(type, da_type)                                      \
+for (size_t count = 0; count < 600; count += 7)                         \
+for (int mode = 0; mode < 4; ++mode) {                                  \
+    int exclusive = mode & 1, in_place = mode & 2;                      \
+    da_type src = {0}, dst = {0};                                       \
+    type* expected = malloc((count + 1) * sizeof(type));                \
+    CHECK(expected != NULL);                                            \
+    type sum = 0;                                                       \
+    for (size_t i = 0; i < count; ++i) {                                \
+        type item = (type)(test_random() % 100);                        \
+        da_append(type)(&src, item);                                    \
+        expected[i] = exclusive ? sum : sum + item;                     \
+        sum += item;                                                    \
+    }                                                                   \
+    da_type* out = in_place ? &src : &dst;                              \
+    da_pool* pool = da_pool_create(1 + count % 5);                      \
+    if (exclusive) da_parallel_exclusive_scan(type)(out, &src, pool);   \
+    else da_parallel_inclusive_scan(type)(out, &src, pool);             \
+    da_pool_destroy(pool);                                              \
+    CHECK(out->count == count);                                         \
+    for (size_t i = 0; i < count; ++i)                                  \
+        CHECK(out->items[i] == expected[i]);                            \
+    free(expected);                                                     \
+    da_free(type)(&src);                                                \
+    da_free(type)(&dst);                                                \
+}
+
+int main(void) {
+    CHECK_SCANS(int, ints_t)
+    CHECK_SCANS(long, longs_t)
+    puts("parallel_scan: ok");
+    return 0;
+}
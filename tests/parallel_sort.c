@@ -0,0 +1,61 @@
+/* Sample sort on pool: random, few keys, all equal, sorted input */
+
+#define DA_ENABLE_THREADS
+#define DA_PARALLEL_SORT_THRESHOLD 1000
+#include "../dynamic_array.h"
+#include "check.h"
+
+#define int_less(a, b) ((a) < (b))
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_SORT(int, int_less)
+DA_DEFINE_PARALLEL_SORT(int, int_less)
+
+enum { RANDOM, FEW_KEYS, EQUAL, ASCENDING, DESCENDING, KINDS };
+
+static int make_item(int kind, size_t i, size_t count) {
+    switch (kind) {
+    case RANDOM: return (int)(test_random() >> 33);
+    case FEW_KEYS: return (int)(test_random() % 3);
+    case EQUAL: return 7;
+    case ASCENDING: return (int)i;
+    default: return (int)(count - i);
+    }
+}
+
+int main(void) {
+    static const size_t counts[] = {0, 1, 2, 17, 1000, 5000, 200000};
+    static int histogram[2][4];
+    for (int kind = 0; kind < KINDS; ++kind)
+    for (size_t c = 0; c < sizeof(counts) / sizeof(*counts); ++c)
+    for (size_t threads = 1; threads <= 7; threads += 3) {
+        size_t count = counts[c];
+        ints_t da = {0};
+        long long sum = 0, sorted_sum = 0;
+        for (size_t i = 0; i < count; ++i) {
+            int item = make_item(kind, i, count);
+            da_append(int)(&da, item);
+            sum += item;
+        }
+        if (kind == FEW_KEYS) {
+            memset(histogram, 0, sizeof(histogram));
+            DA_FOREACH(int, item, &da) ++histogram[0][*item];
+        }
+        da_pool* pool = da_pool_create(threads);
+        da_parallel_sort(int)(&da, pool);
+        da_pool_destroy(pool);
+        CHECK(da.count == count);
+        for (size_t i = 0; i < count; ++i) {
+            if (i > 0) CHECK(da.items[i - 1] <= da.items[i]);
+            sorted_sum += da.items[i];
+        }
+        CHECK(sum == sorted_sum);
+        if (kind == FEW_KEYS) {
+            DA_FOREACH(int, item, &da) ++histogram[1][*item];
+            CHECK(memcmp(histogram[0], histogram[1],
+                sizeof(histogram[0])) == 0);
+        }
+        da_free(int)(&da);
+    }
+    puts("parallel_sort: ok");
+    return 0;
+}
@@ -0,0 +1,81 @@
+/* Work-stealing pool: every index once, grain kept, nested calls */
+
+#include "../da_pool.h"
+#include "check.h"
+#include <string.h>
+
+#define MAX_COUNT 50000
+
+static _Atomic int hits[MAX_COUNT];
+static _Atomic size_t longest;
+static da_pool* pool;
+
+static void note_range(size_t begin, size_t end) {
+    size_t seen = atomic_load(&longest);
+    while (end - begin > seen
+        && !atomic_compare_exchange_weak(&longest, &seen, end - begin)) {}
+}
+
+static void mark(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    note_range(begin, end);
+    for (size_t i = begin; i < end; ++i) {
+        atomic_fetch_add(&hits[i], 1);
+        /* uneven work for stealing */
+        if (i % 97 == 0)
+            for (volatile int k = 0; k < 2000; ++k) {}
+    }
+}
+
+#define OUTER 32
+#define INNER 50
+static _Atomic int nested_hits[OUTER][INNER];
+
+static void mark_inner(void* ctx, size_t begin, size_t end) {
+    note_range(begin, end);
+    for (size_t i = begin; i < end; ++i)
+        atomic_fetch_add(&nested_hits[(size_t)ctx][i], 1);
+}
+
+/* nested call run on calling thread, still by grain */
+static void run_inner(void* ctx, size_t begin, size_t end) {
+    (void)ctx;
+    for (size_t i = begin; i < end; ++i)
+        da_pool_parallel_for(pool, INNER, 3, mark_inner, (void*)i);
+}
+
+static void check_loop(da_pool* target, size_t count, size_t grain) {
+    memset(hits, 0, sizeof(hits));
+    atomic_store(&longest, 0);
+    da_pool_parallel_for(target, count, grain, mark, NULL);
+    for (size_t i = 0; i < MAX_COUNT; ++i)
+        CHECK(atomic_load(&hits[i]) == (i < count));
+    if (count > 0)
+        CHECK(atomic_load(&longest) <= (grain > 0 ? grain : 1));
+}
+
+int main(void) {
+    for (size_t threads = 1; threads <= 4; threads += 3) {
+        pool = da_pool_create(threads);
+        CHECK(pool != NULL && da_pool_threads(pool) == threads);
+        for (size_t round = 0; round < 100; ++round) {
+            size_t count = round * 499 % MAX_COUNT;
+            check_loop(pool, count, round % 7);
+        }
+        check_loop(NULL, 1000, 10);
+        check_loop(pool, MAX_COUNT, MAX_COUNT);
+
+        memset(nested_hits, 0, sizeof(nested_hits));
+        atomic_store(&longest, 0);
+        da_pool_parallel_for(pool, OUTER, 1, run_inner, NULL);
+        for (size_t i = 0; i < OUTER; ++i)
+            for (size_t j = 0; j < INNER; ++j)
+                CHECK(atomic_load(&nested_hits[i][j]) == 1);
+        CHECK(atomic_load(&longest) <= 3);
+        da_pool_destroy(pool);
+    }
+    da_pool_destroy(NULL);
+    CHECK(da_pool_threads(NULL) == 1);
+    puts("pool: ok");
+    return 0;
+}
@@ -0,0 +1,52 @@
+/* Reductions against plain loop, accuracy of pairwise and Kahan sums */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_REDUCE(int)
+DA_DEFINE_ALL(float, floats_t)
+DA_DEFINE_REDUCE(float)
+DA_DEFINE_SUM_PAIRWISE(float)
+DA_DEFINE_SUM_KAHAN(float)
+
+int main(void) {
+    for (size_t count = 1; count < 200; ++count) {
+        ints_t da = {0};
+        /* few values, so extremes repeat in several lanes */
+        for (size_t i = 0; i < count; ++i)
+            da_append(int)(&da, (int)(test_random() % 21) - 10);
+        int sum = 0, min = da.items[0], max = da.items[0];
+        size_t argmin = 0, argmax = 0;
+        for (size_t i = 0; i < count; ++i) {
+            sum += da.items[i];
+            if (da.items[i] < min) min = da.items[argmin = i];
+            if (da.items[i] > max) max = da.items[argmax = i];
+        }
+        int low, high;
+        da_minmax(int)(&da, &low, &high);
+        CHECK(low == min && high == max);
+        CHECK(da_sum(int)(&da) == sum);
+        CHECK(da_min(int)(&da) == min && da_max(int)(&da) == max);
+        CHECK(da_argmin(int)(&da) == argmin);
+        CHECK(da_argmax(int)(&da) == argmax);
+        da_free(int)(&da);
+    }
+    ints_t empty = {0};
+    CHECK(da_sum(int)(&empty) == 0);
+    /* 4M floats near 1: float running sum drifts, these must not */
+    floats_t floats = {0};
+    double exact = 0;
+    for (int i = 0; i < 4000000; ++i) {
+        float item = 1.0f + (float)(i % 1000) * 1e-4f;
+        da_append(float)(&floats, item);
+        exact += item;
+    }
+    double pairwise = da_sum_pairwise(float)(&floats);
+    double kahan = da_sum_kahan(float)(&floats);
+    CHECK(pairwise > exact * (1 - 1e-6) && pairwise < exact * (1 + 1e-6));
+    CHECK(kahan > exact * (1 - 1e-6) && kahan < exact * (1 + 1e-6));
+    da_free(float)(&floats);
+    puts("reduce: ok");
+    return 0;
+}
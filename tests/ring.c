@@ -0,0 +1,72 @@
+/* SPSC ring: values arrive in order through single and batched calls */
+
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_RING(long, ring_t)
+DA_DEFINE_RING_INIT(long)
+DA_DEFINE_RING_PUSH(long)
+DA_DEFINE_RING_POP(long)
+DA_DEFINE_RING_PUSH_MANY(long)
+DA_DEFINE_RING_POP_MANY(long)
+DA_DEFINE_RING_FREE(long)
+
+#define COUNT 1000000L
+
+static ring_t ring;
+static size_t destroyed;
+static void count_dtor(long* item) { (void)item; ++destroyed; }
+
+/* odd batch sizes, so copies cross the wrap point */
+static void* producer(void* arg) {
+    long next = 0, batch[37];
+    (void)arg;
+    while (next < COUNT) {
+        if (next % 3 == 0) {
+            if (da_ring_push(long)(&ring, next)) ++next;
+            else sched_yield();
+            continue;
+        }
+        long count = 0;
+        for (; count < 37 && next + count < COUNT; ++count)
+            batch[count] = next + count;
+        next += (long)da_ring_push_many(long)(&ring, batch, (size_t)count);
+    }
+    return NULL;
+}
+
+int main(void) {
+    /* edges on one thread: capacity rounded up, full and empty */
+    da_ring_init(long)(&ring, 5, count_dtor);
+    CHECK(ring.mask == 7);
+    long values[10] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9}, out[10], item;
+    CHECK(da_ring_push_many(long)(&ring, values, 10) == 8);
+    CHECK(!da_ring_push(long)(&ring, 8));
+    CHECK(da_ring_pop_many(long)(&ring, out, 3) == 3 && out[2] == 2);
+    CHECK(da_ring_push_many(long)(&ring, values + 8, 2) == 2);
+    CHECK(da_ring_pop(long)(&ring, &item) && item == 3);
+    da_ring_free(long)(&ring);
+    CHECK(destroyed == 6);
+
+    da_ring_init(long)(&ring, 1000, NULL);
+    CHECK(ring.mask == 1023);
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, producer, NULL) == 0);
+    long next = 0, batch[50];
+    while (next < COUNT) {
+        if (next % 2 == 1) {
+            if (da_ring_pop(long)(&ring, &item)) CHECK(item == next++);
+            else sched_yield();
+            continue;
+        }
+        size_t count = da_ring_pop_many(long)(&ring, batch, 50);
+        for (size_t i = 0; i < count; ++i)
+            CHECK(batch[i] == next++);
+    }
+    pthread_join(thread, NULL);
+    CHECK(!da_ring_pop(long)(&ring, &item));
+    da_ring_free(long)(&ring);
+    puts("ring: ok");
+    return 0;
+}
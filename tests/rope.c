@@ -0,0 +1,80 @@
+/* Randomized insert/remove on rope against plain 'da' */
+
+/* small leaves for deep tree and many splits and merges */
+#define DA_ROPE_LEAF_BYTES 64
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_ROPE(int, rope_t)
+DA_DEFINE_ROPE_AT(int)
+DA_DEFINE_ROPE_INSERT_AT(int)
+DA_DEFINE_ROPE_APPEND(int)
+DA_DEFINE_ROPE_REMOVE_AT(int)
+DA_DEFINE_ROPE_FREE(int)
+DA_DEFINE_ALL(int, ints_t)
+
+static void ref_insert(ints_t* ref, size_t index, int value) {
+    da_append(int)(ref, value);
+    memmove(ref->items + index + 1, ref->items + index,
+        (ref->count - 1 - index) * sizeof(int));
+    ref->items[index] = value;
+}
+
+static size_t destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+static void check_equal(const rope_t* rope, const ints_t* ref) {
+    CHECK(rope->count == ref->count);
+    size_t i = 0;
+    DA_ROPE_FOREACH(int, item, rope) {
+        CHECK(i < ref->count && *item == ref->items[i]);
+        ++i;
+    }
+    CHECK(i == ref->count);
+    for (size_t k = 0; k < ref->count; k += 1 + ref->count / 64)
+        CHECK(*da_rope_at(int)(rope, k) == ref->items[k]);
+}
+
+int main(void) {
+    rope_t rope = {0};
+    rope.dtor = count_dtor;
+    ints_t ref = {0};
+    size_t removed = 0;
+    /* grow, shrink, grow again and shrink to empty */
+    for (int phase = 0; phase < 4; ++phase) {
+        int growing = phase % 2 == 0;
+        for (int step = 0; step < 40000; ++step) {
+            uint64_t r = test_random();
+            int insert = ref.count == 0
+                || (growing ? r % 4 != 0 : r % 4 == 0);
+            if (insert) {
+                size_t index = (r >> 8) % (ref.count + 1);
+                da_rope_insert_at(int)(&rope, index, step);
+                ref_insert(&ref, index, step);
+            } else {
+                size_t index = (r >> 8) % ref.count;
+                CHECK(*da_rope_at(int)(&rope, index) == ref.items[index]);
+                da_rope_remove_at(int)(&rope, index);
+                da_remove(int)(&ref, index);
+                ++removed;
+            }
+        }
+        check_equal(&rope, &ref);
+    }
+    while (rope.count > 0) {
+        da_rope_remove_at(int)(&rope, rope.count / 2);
+        da_remove(int)(&ref, ref.count / 2);
+        ++removed;
+    }
+    check_equal(&rope, &ref);
+    CHECK(rope.height == 0);
+    da_rope_append(int)(&rope, 1);
+    da_rope_append(int)(&rope, 2);
+    CHECK(*da_rope_at(int)(&rope, 1) == 2);
+    da_rope_free(int)(&rope);
+    CHECK(rope.count == 0 && rope.root == NULL);
+    CHECK(destroyed == removed + 2);
+    da_free(int)(&ref);
+    puts("rope: ok");
+    return 0;
+}
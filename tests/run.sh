@@ -0,0 +1,21 @@
+#!/bin/sh
+# Build every test with sanitizers and run it, from any directory.
+# Set CC or CFLAGS to override compiler and flags.
+cd "$(dirname "$0")" || exit 1
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:-"-std=c11 -Wall -Wextra -pedantic -O1 -g \
+-fsanitize=address,undefined -fno-sanitize-recover=undefined"}
+out=$(mktemp -d) || exit 1
+trap 'rm -rf "$out"' EXIT
+status=0
+for test in *.c; do
+    name=${test%.c}
+    if ! $CC $CFLAGS -pthread "$test" -o "$out/$name"; then
+        echo "$name: build failed"
+        status=1
+    elif ! "$out/$name"; then
+        echo "$name: failed"
+        status=1
+    fi
+done
+exit $status
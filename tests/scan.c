@@ -0,0 +1,63 @@
+/* Serial prefix sums against plain loop, in place and to other da */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_SCAN(int)
+DA_DEFINE_ALL(long, longs_t)
+DA_DEFINE_SCAN(long)
+DA_DEFINE_ALL(short, shorts_t)
+DA_DEFINE_SCAN(short)
+DA_DEFINE_ALL(double, doubles_t)
+DA_DEFINE_SCAN(double)
+
+/* check scans of `type` for every count and mode, sums are exact */
+#define CHECK_SCANS(type, da_type)                                      \
+for (size_t count = 0; count < 100; ++count)                            \
+for (int mode = 0; mode < 4; ++mode) {                                  \
+    int exclusive = mode & 1, in_place = mode & 2;                      \
+    da_type src = {0}, dst = {0};                                       \
+    type expected[100];                                                 \
+    type sum = 0;                                                       \
+    for (size_t i = 0; i < count; ++i) {                                \
+        type item = (type)(test_random() % 100);                        \
+        da_append(type)(&src, item);                                    \
+        expected[i] = exclusive ? sum : (type)(sum + item);             \
+        sum = (type)(sum + item);                                       \
+    }                                                                   \
+    da_type* out = in_place ? &src : &dst;                              \
+    if (exclusive) da_exclusive_scan(type)(out, &src);                  \
+    else da_inclusive_scan(type)(out, &src);                            \
+    CHECK(out->count == count);                                         \
+    for (size_t i = 0; i < count; ++i)                                  \
+        CHECK(out->items[i] == expected[i]);                            \
+    da_free(type)(&src);                                                \
+    da_free(type)(&dst);                                                \
+}
+
+static size_t destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+int main(void) {
+    /* old items of other dst destroyed, scan in place keeps items */
+    ints_t src = {0}, dst = {0};
+    dst.dtor = src.dtor = count_dtor;
+    for (int i = 0; i < 10; ++i) da_append(int)(&dst, i);
+    for (int i = 0; i < 4; ++i) da_append(int)(&src, 1);
+    da_inclusive_scan(int)(&dst, &src);
+    CHECK(destroyed == 10 && dst.count == 4 && dst.items[3] == 4);
+    da_exclusive_scan(int)(&src, &src);
+    CHECK(destroyed == 10 && src.items[3] == 3);
+    dst.dtor = src.dtor = NULL;
+    da_free(int)(&src);
+    da_free(int)(&dst);
+
+    /* int and long go to SIMD kernel, short and double to loop */
+    CHECK_SCANS(int, ints_t)
+    CHECK_SCANS(long, longs_t)
+    CHECK_SCANS(short, shorts_t)
+    CHECK_SCANS(double, doubles_t)
+    puts("scan: ok");
+    return 0;
+}
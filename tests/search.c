@@ -0,0 +1,34 @@
+/* Binary search family against linear scan, with duplicates and misses */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+#define int_less(a, b) ((a) < (b))
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_SORT(int, int_less)
+DA_DEFINE_SEARCH(int, int_less)
+
+int main(void) {
+    for (size_t count = 0; count < 300; ++count)
+    for (int round = 0; round < 4; ++round) {
+        ints_t da = {0};
+        /* keys in [0, 50) leave runs of equal items and gaps */
+        for (size_t i = 0; i < count; ++i)
+            da_append(int)(&da, (int)(test_random() % 50));
+        da_sort(int)(&da);
+        for (int value = -2; value < 53; ++value) {
+            size_t lower = 0, upper, first, last;
+            while (lower < count && da.items[lower] < value) ++lower;
+            upper = lower;
+            while (upper < count && da.items[upper] == value) ++upper;
+            CHECK(da_lower_bound(int)(&da, value) == lower);
+            CHECK(da_upper_bound(int)(&da, value) == upper);
+            da_equal_range(int)(&da, value, &first, &last);
+            CHECK(first == lower && last == upper);
+            CHECK(!da_binary_search(int)(&da, value) == (lower == upper));
+        }
+        da_free(int)(&da);
+    }
+    puts("search: ok");
+    return 0;
+}
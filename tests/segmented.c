@@ -0,0 +1,40 @@
+/* Segmented array: addresses stay valid while it grows, O(1) indexing */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_SEGMENTED_STRUCT(int, segmented_t)
+DA_DEFINE_SEGMENTED_AT(int)
+DA_DEFINE_SEGMENTED_APPEND(int)
+DA_DEFINE_SEGMENTED_FREE(int)
+
+#define COUNT 20000
+
+static int* pointers[COUNT];
+static size_t destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+int main(void) {
+    CHECK(da_impl_log2(1) == 0 && da_impl_log2(64) == 6);
+    CHECK(da_impl_log2(SIZE_MAX) == sizeof(size_t) * 8 - 1);
+    segmented_t sa = {0};
+    sa.dtor = count_dtor;
+    for (int i = 0; i < COUNT; ++i) {
+        pointers[i] = da_segmented_append(int)(&sa, i);
+        /* earlier items are not moved by growth */
+        if (i % 1000 == 999)
+            for (int k = 0; k <= i; ++k)
+                CHECK(*pointers[k] == k);
+    }
+    CHECK(sa.count == COUNT);
+    for (int i = 0; i < COUNT; ++i)
+        CHECK(da_segmented_at(int)(&sa, (size_t)i) == pointers[i]);
+    int expected = 0;
+    DA_SEGMENTED_FOREACH(int, item, &sa)
+        CHECK(item == pointers[expected] && *item == expected++);
+    CHECK(expected == COUNT);
+    da_segmented_free(int)(&sa);
+    CHECK(destroyed == COUNT && sa.count == 0);
+    puts("segmented: ok");
+    return 0;
+}
@@ -0,0 +1,88 @@
+/* Seqlock array: readers get only consistent snapshots during changes */
+
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_STRUCT(long, longs_t)
+DA_DEFINE_SEQLOCK_STRUCT(long, seqlock_t)
+DA_DEFINE_SEQLOCK_WRITE_BEGIN(long)
+DA_DEFINE_SEQLOCK_WRITE_END(long)
+DA_DEFINE_SEQLOCK_READ_BEGIN(long)
+DA_DEFINE_SEQLOCK_READ_RETRY(long)
+DA_DEFINE_SEQLOCK_ITEMS(long)
+DA_DEFINE_SEQLOCK_COPY(long)
+DA_DEFINE_SEQLOCK_APPEND(long)
+DA_DEFINE_SEQLOCK_REMOVE(long)
+DA_DEFINE_SEQLOCK_FREE(long)
+
+#define READERS 3
+#define MAX 2000
+
+/* optimistic reads race with writer by design, TSan reports them */
+#if defined(__SANITIZE_THREAD__)
+#define RUN_READERS 0
+#elif defined(__has_feature)
+#if __has_feature(thread_sanitizer)
+#define RUN_READERS 0
+#endif
+#endif
+#ifndef RUN_READERS
+#define RUN_READERS READERS
+#endif
+
+static seqlock_t shared;
+static _Atomic int done;
+
+/* writer keeps items as run of consecutive values */
+static void check_run(const long* items, size_t count) {
+    for (size_t i = 1; i < count; ++i)
+        CHECK(items[i] == items[0] + (long)i);
+}
+
+static void* reader(void* arg) {
+    static _Thread_local long copy[MAX];
+    for (size_t round = 0; !atomic_load(&done); ++round) {
+        if ((size_t)arg % 2 == 0) {
+            size_t count = da_seqlock_copy(long)(&shared, copy, MAX);
+            check_run(copy, count < MAX ? count : MAX);
+            continue;
+        }
+        /* optimistic sum over items in place, checked after retry */
+        unsigned seq;
+        long first, sum;
+        size_t count;
+        do {
+            seq = da_seqlock_read_begin(long)(&shared);
+            const long* items = da_seqlock_items(long)(&shared, &count);
+            first = count > 0 ? items[0] : 0;
+            sum = 0;
+            for (size_t i = 0; i < count; ++i) sum += items[i];
+        } while (da_seqlock_read_retry(long)(&shared, seq));
+        CHECK(sum == (long)count * first + (long)(count * (count - 1) / 2));
+    }
+    return NULL;
+}
+
+int main(void) {
+    pthread_t threads[READERS];
+    size_t readers = RUN_READERS;
+    for (size_t t = 0; t < readers; ++t)
+        CHECK(pthread_create(&threads[t], NULL, reader, (void*)t) == 0);
+    for (long i = 0; i < 1000; ++i)
+        da_seqlock_append(long)(&shared, i);
+    for (int i = 0; i < 500; ++i)
+        da_seqlock_remove(long)(&shared, 0);
+    /* change in place between write_begin and write_end */
+    da_seqlock_write_begin(long)(&shared);
+    DA_FOREACH(long, item, &shared.da) *item += 1000;
+    da_seqlock_write_end(long)(&shared);
+    atomic_store(&done, 1);
+    for (size_t t = 0; t < readers; ++t)
+        pthread_join(threads[t], NULL);
+    CHECK(shared.da.count == 500 && shared.da.items[0] == 1500);
+    check_run(shared.da.items, shared.da.count);
+    da_seqlock_free(long)(&shared);
+    puts("seqlock: ok");
+    return 0;
+}
@@ -0,0 +1,65 @@
+/* Sharded appends from threads, collect keeps shard order and capacity */
+
+#define DA_ENABLE_THREADS
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_SHARDED_STRUCT(int, sharded_t)
+DA_DEFINE_SHARDED_INIT(int)
+DA_DEFINE_SHARDED_APPEND(int)
+DA_DEFINE_SHARDED_COLLECT(int)
+DA_DEFINE_SHARDED_FREE(int)
+
+#define SHARDS 4
+
+static sharded_t sharded;
+
+/* shard `id` gets values id * 100000 + i, different counts */
+static size_t shard_count(size_t id) { return 10000 + id * 100; }
+
+static void* producer(void* arg) {
+    size_t id = (size_t)arg;
+    for (size_t i = 0; i < shard_count(id); ++i)
+        da_sharded_append(int)(&sharded, id, (int)(id * 100000 + i));
+    return NULL;
+}
+
+int main(void) {
+    da_sharded_init(int)(&sharded, SHARDS, NULL);
+    da_pool* pool = da_pool_create(3);
+    ints_t out = {0};
+    da_append(int)(&out, -1);
+    for (int round = 0; round < 2; ++round) {
+        pthread_t threads[SHARDS];
+        for (size_t t = 0; t < SHARDS; ++t)
+            CHECK(pthread_create(&threads[t], NULL,
+                producer, (void*)t) == 0);
+        for (size_t t = 0; t < SHARDS; ++t)
+            pthread_join(threads[t], NULL);
+        size_t before = out.count;
+        da_sharded_collect(int)(&sharded, &out, round ? pool : NULL);
+        /* shards are empty, capacity stays for next batch */
+        for (size_t t = 0; t < SHARDS; ++t)
+            CHECK(sharded.shards[t].da.count == 0
+                && sharded.shards[t].da.capacity >= shard_count(t));
+        size_t k = before;
+        for (size_t t = 0; t < SHARDS; ++t)
+            for (size_t i = 0; i < shard_count(t); ++i)
+                CHECK(out.items[k++] == (int)(t * 100000 + i));
+        CHECK(out.count == k);
+    }
+    CHECK(out.items[0] == -1);
+    da_sharded_free(int)(&sharded);
+
+    /* zero shards collect nothing */
+    size_t count = out.count;
+    da_sharded_init(int)(&sharded, 0, NULL);
+    da_sharded_collect(int)(&sharded, &out, pool);
+    CHECK(sharded.shards == NULL && out.count == count);
+    da_sharded_free(int)(&sharded);
+    da_pool_destroy(pool);
+    da_free(int)(&out);
+    puts("sharded: ok");
+    return 0;
+}
@@ -0,0 +1,76 @@
+/* SIMD chosen by size of type only, as in C99 with DA_SIMD_INTEGERS */
+
+#define DA_SIMD_INTEGERS
+#include "../dynamic_array.h"
+#include "check.h"
+
+typedef signed char schar;
+typedef const char* cstr;
+DA_DEFINE_ALL(schar, schars_t)
+DA_DEFINE_FIND(schar)
+DA_DEFINE_COUNT(schar)
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_FIND(int)
+DA_DEFINE_COUNT(int)
+DA_DEFINE_SCAN(int)
+DA_DEFINE_ALL(long, longs_t)
+DA_DEFINE_FIND(long)
+DA_DEFINE_COUNT(long)
+DA_DEFINE_SCAN(long)
+DA_DEFINE_ALL(cstr, cstrs_t)
+DA_DEFINE_FIND(cstr)
+
+/* compare find and count of `type` with loop for values [0, 9] */
+#define CHECK_SEARCH(type, da)                                      \
+for (int v = 0; v <= 9; ++v) {                                      \
+    size_t first = (da)->count, found = 0;                          \
+    for (size_t i = 0; i < (da)->count; ++i)                        \
+        if ((da)->items[i] == (type)v) {                            \
+            if (first == (da)->count) first = i;                    \
+            ++found;                                                \
+        }                                                           \
+    CHECK(da_find(type)(da, (type)v) == first);                     \
+    CHECK(da_count(type)(da, (type)v) == found);                    \
+}
+
+/* compare inclusive scan of `type` in place with running sum */
+#define CHECK_SCAN(type, da)                                        \
+do {                                                                \
+    type sum = 0, expected[200];                                    \
+    for (size_t i = 0; i < (da)->count; ++i)                        \
+        expected[i] = sum += (da)->items[i];                        \
+    da_inclusive_scan(type)(da, da);                                \
+    for (size_t i = 0; i < (da)->count; ++i)                        \
+        CHECK((da)->items[i] == expected[i]);                       \
+} while (0)
+
+int main(void) {
+    CHECK(DA_IMPL_IS_SIMD_SCALAR(int) && DA_IMPL_IS_SIMD_SCALAR(cstr));
+    for (size_t count = 0; count < 200; ++count) {
+        schars_t chars = {0};
+        ints_t ints = {0};
+        longs_t longs = {0};
+        for (size_t i = 0; i < count; ++i) {
+            int item = (int)(test_random() % 9);
+            da_append(schar)(&chars, (schar)item);
+            da_append(int)(&ints, item);
+            da_append(long)(&longs, item);
+        }
+        CHECK_SEARCH(schar, &chars)
+        CHECK_SEARCH(int, &ints)
+        CHECK_SEARCH(long, &longs)
+        CHECK_SCAN(int, &ints);
+        CHECK_SCAN(long, &longs);
+        da_free(schar)(&chars);
+        da_free(int)(&ints);
+        da_free(long)(&longs);
+    }
+    cstrs_t strings = {0};
+    static const char a[] = "a", b[] = "b";
+    const cstr words[] = {a, b, b};
+    da_append_many(cstr)(&strings, words, 3);
+    CHECK(da_find(cstr)(&strings, words[2]) == 1);
+    da_free(cstr)(&strings);
+    puts("simd_integers: ok");
+    return 0;
+}
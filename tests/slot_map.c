@@ -0,0 +1,60 @@
+/* Slot map: handles stay valid until erase, stale handles are rejected */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_SLOTMAP(int, slotmap_t)
+DA_DEFINE_SLOTMAP_INSERT(int)
+DA_DEFINE_SLOTMAP_GET(int)
+DA_DEFINE_SLOTMAP_ERASE(int)
+DA_DEFINE_SLOTMAP_FREE(int)
+
+#define COUNT 5000
+
+static da_handle handles[COUNT];
+static int alive[COUNT];
+static size_t destroyed;
+static void count_dtor(int* item) { (void)item; ++destroyed; }
+
+int main(void) {
+    slotmap_t map = {0};
+    map.dtor = count_dtor;
+    size_t erased = 0;
+    for (int i = 0; i < COUNT; ++i) {
+        handles[i] = da_slotmap_insert(int)(&map, i);
+        alive[i] = 1;
+        /* erase random earlier handle, some are erased twice */
+        if (test_random() % 3 == 0) {
+            size_t j = test_random() % (size_t)(i + 1);
+            int erased_now = da_slotmap_erase(int)(&map, handles[j]);
+            CHECK(erased_now == alive[j]);
+            if (erased_now) {
+                alive[j] = 0;
+                ++erased;
+            }
+        }
+    }
+    size_t live = 0;
+    long expected = 0;
+    for (int i = 0; i < COUNT; ++i) {
+        int* item = da_slotmap_get(int)(&map, handles[i]);
+        if (!alive[i]) {
+            CHECK(item == NULL);
+            continue;
+        }
+        CHECK(item != NULL && *item == i);
+        ++live;
+        expected += i;
+    }
+    CHECK(map.count == live);
+    /* values are dense for plain loops */
+    long sum = 0;
+    DA_FOREACH(int, item, &map) sum += *item;
+    CHECK(sum == expected);
+    /* erased slots are reused */
+    CHECK(map.slots.count < COUNT);
+    da_slotmap_free(int)(&map);
+    CHECK(destroyed == erased + live);
+    puts("slot_map: ok");
+    return 0;
+}
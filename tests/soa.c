@@ -0,0 +1,43 @@
+/* Struct of arrays: values survive growth, every column is aligned */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+DA_DEFINE_SOA(particles, (float, x), (float, y), (double, mass), (char, tag))
+/* declaration and functions apart, as for header and source file */
+DA_DECLARE_SOA(single, (int, value))
+DA_DEFINE_SOA_FUNCTIONS(single, (int, value))
+
+#define COUNT 1000
+
+static int is_aligned(const void* column) {
+    return (uintptr_t)column % DA_SOA_ALIGN == 0;
+}
+
+int main(void) {
+    particles p = {0};
+    for (int i = 0; i < COUNT; ++i) {
+        da_soa_append(particles)(&p, (float)i, (float)-i, i * 0.5,
+            (char)(i & 127));
+        CHECK(is_aligned(p.x) && is_aligned(p.y));
+        CHECK(is_aligned(p.mass) && is_aligned(p.tag));
+    }
+    CHECK(p.count == COUNT && p.capacity >= COUNT);
+    for (int i = 0; i < COUNT; ++i) {
+        CHECK(p.x[i] == (float)i && p.y[i] == (float)-i);
+        CHECK(p.mass[i] == i * 0.5 && p.tag[i] == (char)(i & 127));
+    }
+    da_soa_free(particles)(&p);
+    CHECK(p.count == 0 && p.capacity == 0);
+
+    /* reserve is exact and smaller request keeps capacity */
+    single s = {0};
+    da_soa_reserve(single)(&s, 10);
+    da_soa_reserve(single)(&s, 5);
+    CHECK(s.capacity == 10 && is_aligned(s.value));
+    da_soa_append(single)(&s, 5);
+    CHECK(s.count == 1 && s.value[0] == 5);
+    da_soa_free(single)(&s);
+    puts("soa: ok");
+    return 0;
+}
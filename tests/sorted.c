@@ -0,0 +1,50 @@
+/* Sorted insert and bulk merge keep order, equal values go after */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+/* key in high bits, order of arrival in low bits */
+#define KEY(item) ((item) >> 16)
+#define key_less(a, b) (KEY(a) < KEY(b))
+DA_DEFINE_ALL(int, ints_t)
+DA_DEFINE_SORT(int, key_less)
+DA_DEFINE_SEARCH(int, key_less)
+DA_DEFINE_INSERT_SORTED(int)
+DA_DEFINE_MERGE_SORTED_MANY(int, key_less)
+
+/* sorted by key and items with equal key in order of arrival */
+static void check_order(const ints_t* da) {
+    for (size_t i = 1; i < da->count; ++i)
+        CHECK(da->items[i - 1] < da->items[i]);
+}
+
+int main(void) {
+    int serial = 0;
+    ints_t da = {0}, batch = {0};
+    for (int i = 0; i < 2000; ++i) {
+        int item = (int)(test_random() % 64) << 16 | serial++;
+        size_t index = da_insert_sorted(int)(&da, item);
+        CHECK(da.items[index] == item);
+        check_order(&da);
+    }
+    for (size_t count = 0; count < 500; count += 37) {
+        /* batch arrives after all items of da */
+        batch.count = 0;
+        for (size_t i = 0; i < count; ++i)
+            da_append(int)(&batch, (int)(test_random() % 80) << 16);
+        da_sort(int)(&batch);
+        DA_FOREACH(int, item, &batch) *item |= serial++;
+        size_t before = da.count;
+        da_merge_sorted_many(int)(&da, batch.items, batch.count);
+        CHECK(da.count == before + count);
+        check_order(&da);
+    }
+    da_free(int)(&da);
+    da_merge_sorted_many(int)(&da, batch.items, batch.count);
+    CHECK(da.count == batch.count);
+    check_order(&da);
+    da_free(int)(&da);
+    da_free(int)(&batch);
+    puts("sorted: ok");
+    return 0;
+}
@@ -0,0 +1,54 @@
+/* Sparse set against byte per key model: wide and clustered keys */
+
+#include "../dynamic_array.h"
+#include "check.h"
+
+typedef unsigned int uint;
+
+DA_DEFINE_SPARSE_SET(uint, sparse_t)
+DA_DEFINE_SPARSE_CONTAINS(uint)
+DA_DEFINE_SPARSE_ADD(uint)
+DA_DEFINE_SPARSE_REMOVE(uint)
+DA_DEFINE_SPARSE_FREE(uint)
+
+#define KEYS (1u << 20)
+#define STEPS 200000
+
+static unsigned char model[KEYS];
+
+int main(void) {
+    /* empty set has no pages */
+    sparse_t empty = {0};
+    CHECK(!da_sparse_contains(uint)(&empty, 123456));
+
+    sparse_t set = {0};
+    size_t count = 0;
+    for (int i = 0; i < STEPS; ++i) {
+        uint key = (uint)(test_random() % KEYS);
+        /* some keys in small range, so adds and removes repeat */
+        if (test_random() % 8 == 0) key %= 100;
+        if (test_random() % 3 != 0) {
+            int added = da_sparse_add(uint)(&set, key);
+            CHECK(added == !model[key]);
+            if (added) {
+                model[key] = 1;
+                ++count;
+            }
+        } else {
+            int removed = da_sparse_remove(uint)(&set, key);
+            CHECK(removed == model[key]);
+            if (removed) {
+                model[key] = 0;
+                --count;
+            }
+        }
+    }
+    CHECK(set.count == count);
+    for (uint key = 0; key < KEYS; key += 7)
+        CHECK(da_sparse_contains(uint)(&set, key) == model[key]);
+    DA_FOREACH(uint, key, &set) CHECK(model[*key]);
+    da_sparse_free(uint)(&set);
+    CHECK(set.count == 0);
+    puts("sparse: ok");
+    return 0;
+}